@@ -0,0 +1,52 @@
+//=======================================================================
+/** @file BenchmarkUtilities.h
+ *  @brief Small helpers shared by the Gist benchmarks
+ */
+//=======================================================================
+
+#ifndef GistBenchmarks_BenchmarkUtilities_h
+#define GistBenchmarks_BenchmarkUtilities_h
+
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+
+//=======================================================================
+/** A stopwatch measuring wall clock time in microseconds */
+class BenchmarkTimer
+{
+public:
+    BenchmarkTimer()
+    {
+        reset();
+    }
+    
+    void reset()
+    {
+        start = std::chrono::steady_clock::now();
+    }
+    
+    double getElapsedMicroseconds() const
+    {
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+    
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+//=======================================================================
+/** @Returns a frame of uniformly distributed noise in the range [-0.5, 0.5) */
+template <class T>
+std::vector<T> createNoiseFrame (int numSamples)
+{
+    std::vector<T> frame (numSamples);
+    
+    for (int i = 0; i < numSamples; i++)
+        frame[i] = ((T)((rand() % 1000) - 500)) / (T)1000.;
+    
+    return frame;
+}
+
+#endif
@@ -0,0 +1,97 @@
+//=======================================================================
+/** @file Benchmark_FFTBackends.cpp
+ *  @brief Compares the throughput of the FFT backends on the same frames
+ *
+ * Kiss FFT and the built-in SIMD FFT are always measured. FFTW is added
+ * when the library is configured with -DUSE_FFTW=ON. The last column shows
+ * the backend that AutomaticFFTBackend picks for each frame size
+ */
+//=======================================================================
+
+#include <Gist.h>
+#include <SimdFFT.h>
+#include <cstdio>
+#include "BenchmarkUtilities.h"
+
+//=======================================================================
+static const char* getBackendName (FFTBackend backend)
+{
+    switch (backend)
+    {
+        case KissFFTBackend: return "kiss";
+        case FFTWBackend: return "fftw";
+        case AccelerateFFTBackend: return "accelerate";
+        case SimdFFTBackend: return "simd";
+        default: return "unknown";
+    }
+}
+
+//=======================================================================
+/** @Returns the time per frame in microseconds of an FFT backend, or -1 if it is not available */
+template <class T>
+double timeFFT (FFTBackend backend, int frameSize, int numFrames)
+{
+    if (! FFTEngine<T>::isBackendAvailable (backend, frameSize))
+        return -1;
+    
+    std::vector<T> frame = createNoiseFrame<T> (frameSize);
+    std::vector<T> real (frameSize / 2 + 1);
+    std::vector<T> imag (frameSize / 2 + 1);
+    
+    std::unique_ptr<FFTEngine<T>> fft = FFTEngine<T>::create (backend);
+    fft->setAudioFrameSize (frameSize);
+    
+    // warm up the caches before timing
+    for (int i = 0; i < 100; i++)
+        fft->performFFT (frame.data(), real.data(), imag.data());
+    
+    BenchmarkTimer timer;
+    
+    for (int i = 0; i < numFrames; i++)
+        fft->performFFT (frame.data(), real.data(), imag.data());
+    
+    return timer.getElapsedMicroseconds() / numFrames;
+}
+
+//=======================================================================
+template <class T>
+void benchmarkBackends (const char* precisionName)
+{
+    const int frameSizes[] = {256, 512, 1024, 2048, 4096};
+    const FFTBackend backends[] = {KissFFTBackend, SimdFFTBackend, FFTWBackend, AccelerateFFTBackend};
+    
+    printf ("\n%s precision (SIMD FFT uses %s)\n", precisionName, SimdFFT<T>::getInstructionSetName());
+    printf ("%-10s", "frame size");
+    
+    for (FFTBackend backend : backends)
+        printf (" %12s (us)", getBackendName (backend));
+    
+    printf (" %12s\n", "automatic");
+    
+    for (int frameSize : frameSizes)
+    {
+        int numFrames = 20000000 / frameSize;
+        printf ("%-10d", frameSize);
+        
+        for (FFTBackend backend : backends)
+        {
+            double timePerFrame = timeFFT<T> (backend, frameSize, numFrames);
+            
+            if (timePerFrame < 0)
+                printf (" %17s", "-");
+            else
+                printf (" %17.3f", timePerFrame);
+        }
+        
+        printf (" %12s\n", getBackendName (FFTEngine<T>::findFastestBackend (frameSize)));
+    }
+}
+
+//=======================================================================
+int main()
+{
+    benchmarkBackends<float> ("single");
+    benchmarkBackends<double> ("double");
+    
+    return 0;
+}
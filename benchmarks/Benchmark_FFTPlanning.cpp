@@ -0,0 +1,101 @@
+//=======================================================================
+/** @file Benchmark_FFTPlanning.cpp
+ *  @brief Compares FFTW planning rigors and the effect of saved wisdom
+ *
+ * Build with -DBUILD_BENCHMARKS=ON -DUSE_FFTW=ON
+ */
+//=======================================================================
+
+#include <Gist.h>
+#include <iostream>
+#include <cstdio>
+#include "BenchmarkUtilities.h"
+
+#ifdef USE_FFTW
+
+//=======================================================================
+static const char* getRigorName (FFTPlanningRigor rigor)
+{
+    if (rigor == PatientPlanning)
+        return "patient";
+    else if (rigor == MeasurePlanning)
+        return "measure";
+    else
+        return "estimate";
+}
+
+//=======================================================================
+int main()
+{
+    const int numFrames = 20000;
+    const int frameSizes[] = {512, 1024, 2048, 4096, 8192};
+    const FFTPlanningRigor rigors[] = {EstimatePlanning, MeasurePlanning, PatientPlanning};
+    const std::string wisdomFile = "gist_benchmark_fftw_wisdom.dat";
+    
+    printf ("%-10s %-10s %16s %16s\n", "frame size", "rigor", "planning (ms)", "per frame (us)");
+    
+    for (int frameSize : frameSizes)
+    {
+        std::vector<float> frame = createNoiseFrame<float> (frameSize);
+        std::vector<float> real (frameSize / 2 + 1);
+        std::vector<float> imag (frameSize / 2 + 1);
+        
+        for (FFTPlanningRigor rigor : rigors)
+        {
+            FFTWFFT<float> fft;
+            
+            BenchmarkTimer planningTimer;
+            fft.setPlanningRigor (rigor);
+            fft.setAudioFrameSize (frameSize);
+            double planningTime = planningTimer.getElapsedMicroseconds() / 1000.;
+            
+            BenchmarkTimer executionTimer;
+            
+            for (int i = 0; i < numFrames; i++)
+                fft.performFFT (frame.data(), real.data(), imag.data());
+            
+            double timePerFrame = executionTimer.getElapsedMicroseconds() / numFrames;
+            
+            printf ("%-10d %-10s %16.3f %16.3f\n", frameSize, getRigorName (rigor), planningTime, timePerFrame);
+        }
+    }
+    
+    // save the wisdom gathered above, forget it and reload it to show the
+    // planning cost a restarted worker pays when it starts from saved wisdom
+    FFTWFFT<float>::saveWisdom (wisdomFile);
+    FFTWFFT<float>::forgetWisdom();
+    
+    if (! FFTWFFT<float>::loadWisdom (wisdomFile))
+    {
+        std::cerr << "Could not load wisdom from " << wisdomFile << std::endl;
+        return 1;
+    }
+    
+    printf ("\n%-10s %-10s %16s\n", "frame size", "rigor", "planning from wisdom (ms)");
+    
+    for (int frameSize : frameSizes)
+    {
+        FFTWFFT<float> fft;
+        
+        BenchmarkTimer planningTimer;
+        fft.setPlanningRigor (PatientPlanning);
+        fft.setAudioFrameSize (frameSize);
+        
+        printf ("%-10d %-10s %16.3f\n", frameSize, getRigorName (PatientPlanning), planningTimer.getElapsedMicroseconds() / 1000.);
+    }
+    
+    std::remove (wisdomFile.c_str());
+    
+    return 0;
+}
+
+#else
+
+//=======================================================================
+int main()
+{
+    std::cout << "This benchmark requires FFTW - configure with -DUSE_FFTW=ON" << std::endl;
+    return 0;
+}
+
+#endif
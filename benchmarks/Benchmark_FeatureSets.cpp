@@ -0,0 +1,67 @@
+//=======================================================================
+/** @file Benchmark_FeatureSets.cpp
+ *  @brief Compares calling the feature functions one by one with computeFeatures()
+ */
+//=======================================================================
+
+#include <Gist.h>
+#include <cstdio>
+#include "BenchmarkUtilities.h"
+
+//=======================================================================
+int main()
+{
+    const int frameSize = 1024;
+    const int numFrames = 20000;
+    const GistFeatureSet features = RootMeanSquareFeature | PeakEnergyFeature | ZeroCrossingRateFeature
+                                  | SpectralCentroidFeature | SpectralCrestFeature | SpectralFlatnessFeature
+                                  | SpectralRolloffFeature | SpectralKurtosisFeature | EnergyDifferenceFeature
+                                  | SpectralDifferenceFeature | SpectralDifferenceHWRFeature | HighFrequencyContentFeature;
+    
+    std::vector<float> frame = createNoiseFrame<float> (frameSize);
+    float checksum = 0;
+    
+    // one call per feature
+    Gist<float> individualGist (frameSize, 44100);
+    BenchmarkTimer individualTimer;
+    
+    for (int i = 0; i < numFrames; i++)
+    {
+        individualGist.processAudioFrame (frame);
+        checksum += individualGist.rootMeanSquare();
+        checksum += individualGist.peakEnergy();
+        checksum += individualGist.zeroCrossingRate();
+        checksum += individualGist.spectralCentroid();
+        checksum += individualGist.spectralCrest();
+        checksum += individualGist.spectralFlatness();
+        checksum += individualGist.spectralRolloff();
+        checksum += individualGist.spectralKurtosis();
+        checksum += individualGist.energyDifference();
+        checksum += individualGist.spectralDifference();
+        checksum += individualGist.spectralDifferenceHWR();
+        checksum += individualGist.highFrequencyContent();
+    }
+    
+    double individualTime = individualTimer.getElapsedMicroseconds() / numFrames;
+    
+    // one call for the whole feature set
+    Gist<float> featureSetGist (frameSize, 44100);
+    std::vector<float> output (featureSetGist.getNumFeatureValues (features));
+    BenchmarkTimer featureSetTimer;
+    
+    for (int i = 0; i < numFrames; i++)
+    {
+        featureSetGist.processAudioFrame (frame);
+        featureSetGist.computeFeatures (features, output.data());
+        checksum += output[0];
+    }
+    
+    double featureSetTime = featureSetTimer.getElapsedMicroseconds() / numFrames;
+    
+    printf ("%d features, frame size %d (checksum %g)\n", (int)output.size(), frameSize, checksum);
+    printf ("%-20s %14s\n", "method", "per frame (us)");
+    printf ("%-20s %14.3f\n", "individual calls", individualTime);
+    printf ("%-20s %14.3f\n", "computeFeatures()", featureSetTime);
+    
+    return 0;
+}
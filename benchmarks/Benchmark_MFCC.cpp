@@ -0,0 +1,75 @@
+//=======================================================================
+/** @file Benchmark_MFCC.cpp
+ *  @brief Times the mel spectrum and MFCC calculations
+ */
+//=======================================================================
+
+#include <MFCC.h>
+#include <algorithm>
+#include <cstdio>
+#include "BenchmarkUtilities.h"
+
+//=======================================================================
+template <class T>
+void benchmarkMFCC (const char* precisionName)
+{
+    const int frameSizes[] = {512, 1024, 2048, 4096};
+    const int bandsAndCoefficients[][2] = {{13, 13}, {40, 13}, {40, 40}, {128, 20}, {128, 128}};
+    T checksum = 0;
+    
+    printf ("\n%s precision\n", precisionName);
+    printf ("%-12s %-8s %-14s %18s %18s\n", "frame size", "bands", "coefficients", "mel spectrum (us)", "MFCCs (us)");
+    
+    for (int frameSize : frameSizes)
+    {
+        std::vector<T> spectrum = createNoiseFrame<T> (frameSize / 2);
+        
+        for (T& v : spectrum)
+            v = v < 0 ? -v : v;
+        
+        for (const int* configuration : bandsAndCoefficients)
+        {
+            int numBands = configuration[0];
+            int numCoefficients = configuration[1];
+            
+            MFCC<T> mfcc (frameSize, 44100);
+            mfcc.setNumMelBands (numBands);
+            mfcc.setNumCoefficients (numCoefficients);
+            
+            const int numIterations = std::max (1000, 100000000 / (frameSize * numBands));
+            
+            BenchmarkTimer melTimer;
+            
+            for (int i = 0; i < numIterations; i++)
+            {
+                mfcc.calculateMelFrequencySpectrum (spectrum);
+                checksum += mfcc.melSpectrum[0];
+            }
+            
+            double melTime = melTimer.getElapsedMicroseconds() / numIterations;
+            
+            BenchmarkTimer mfccTimer;
+            
+            for (int i = 0; i < numIterations; i++)
+            {
+                mfcc.calculateMelFrequencyCepstralCoefficients (spectrum);
+                checksum += mfcc.MFCCs[0];
+            }
+            
+            double mfccTime = mfccTimer.getElapsedMicroseconds() / numIterations;
+            
+            printf ("%-12d %-8d %-14d %18.3f %18.3f\n", frameSize, numBands, numCoefficients, melTime, mfccTime);
+        }
+    }
+    
+    printf ("(checksum %g)\n", (double)checksum);
+}
+
+//=======================================================================
+int main()
+{
+    benchmarkMFCC<float> ("single");
+    benchmarkMFCC<double> ("double");
+    
+    return 0;
+}
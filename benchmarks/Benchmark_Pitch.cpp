@@ -0,0 +1,199 @@
+//=======================================================================
+/** @file Benchmark_Pitch.cpp
+ *  @brief Times the Yin pitch detector with each of its difference function methods
+ */
+//=======================================================================
+
+#include <Yin.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "BenchmarkUtilities.h"
+
+//=======================================================================
+template <class T>
+std::vector<T> createPitchedFrame (int frameSize, T frequency, int fs)
+{
+    std::vector<T> frame = createNoiseFrame<T> (frameSize);
+    
+    for (int i = 0; i < frameSize; i++)
+        frame[i] = (T)(0.9 * sin (2. * M_PI * frequency * i / fs)) + frame[i] * (T)0.05;
+    
+    return frame;
+}
+
+//=======================================================================
+template <class T>
+void benchmarkPitch (const char* precisionName)
+{
+    const int frameSizes[] = {256, 512, 1024, 2048, 4096};
+    T checksum = 0;
+    
+    printf ("\n%s precision\n", precisionName);
+    printf ("%-12s %14s %14s %10s\n", "frame size", "direct (us)", "fft (us)", "speedup");
+    
+    for (int frameSize : frameSizes)
+    {
+        std::vector<T> frame = createPitchedFrame<T> (frameSize, 220, 44100);
+        const int numIterations = std::max (20, 200000000 / (frameSize * frameSize));
+        
+        Yin<T> direct (44100);
+        Yin<T> fft (44100);
+        fft.setDifferenceMethod (FFTDifference);
+        
+        BenchmarkTimer directTimer;
+        
+        for (int i = 0; i < numIterations; i++)
+            checksum += direct.pitchYin (frame);
+        
+        double directTime = directTimer.getElapsedMicroseconds() / numIterations;
+        
+        BenchmarkTimer fftTimer;
+        
+        for (int i = 0; i < numIterations; i++)
+            checksum += fft.pitchYin (frame);
+        
+        double fftTime = fftTimer.getElapsedMicroseconds() / numIterations;
+        
+        printf ("%-12d %14.2f %14.2f %10.2f\n", frameSize, directTime, fftTime, directTime / fftTime);
+    }
+    
+    printf ("(checksum %g)\n", (double)checksum);
+}
+
+//=======================================================================
+template <class T>
+T timeYin (Yin<T>& yin, const std::vector<T>& frame, int numIterations, double& microseconds)
+{
+    T checksum = 0;
+    BenchmarkTimer timer;
+    
+    for (int i = 0; i < numIterations; i++)
+        checksum += yin.pitchYin (frame);
+    
+    microseconds = timer.getElapsedMicroseconds() / numIterations;
+    return checksum;
+}
+
+//=======================================================================
+/** speech-like settings: 16 kHz, 64 ms frames, pitch searched between 60 and 500 Hz */
+template <class T>
+void benchmarkSearchRange (const char* precisionName)
+{
+    const int fs = 16000;
+    const int frameSize = 1024;
+    const int numIterations = 2000;
+    T checksum = 0;
+    
+    std::vector<T> frame = createPitchedFrame<T> (frameSize, 180, fs);
+    
+    printf ("\n%s precision, direct method, %d Hz, frame size %d\n", precisionName, fs, frameSize);
+    printf ("%-30s %10s\n", "configuration", "time (us)");
+    
+    for (int configuration = 0; configuration < 4; configuration++)
+    {
+        bool bounded = (configuration & 1) != 0;
+        bool earlyExit = (configuration & 2) != 0;
+        
+        Yin<T> yin (fs);
+        yin.setMaxFrequency (500);
+        yin.setMinFrequency (bounded ? 60 : 0);
+        yin.setEarlyExit (earlyExit);
+        
+        double time;
+        checksum += timeYin (yin, frame, numIterations, time);
+        
+        printf ("%-30s %10.2f\n", bounded ? (earlyExit ? "60-500 Hz, early exit" : "60-500 Hz")
+                                           : (earlyExit ? "full range, early exit" : "full range"), time);
+    }
+    
+    printf ("(checksum %g)\n", (double)checksum);
+}
+
+//=======================================================================
+/** pitch tracking with 4 ms hops over one second of audio */
+template <class T>
+void benchmarkOverlappingFrames (const char* precisionName)
+{
+    const int fs = 44100;
+    const int frameSize = 2048;
+    const int hopSize = 176;
+    const int numRepeats = 3;
+    T checksum = 0;
+    
+    std::vector<T> signal = createPitchedFrame<T> (fs, 220, fs);
+    int numFrames = (fs - frameSize) / hopSize + 1;
+    
+    printf ("\n%s precision, frame size %d, hop size %d\n", precisionName, frameSize, hopSize);
+    printf ("%-14s %16s\n", "method", "per frame (us)");
+    
+    const YinDifferenceMethod methods[] = {DirectDifference, FFTDifference, IncrementalDifference};
+    const char* methodNames[] = {"direct", "fft", "incremental"};
+    
+    for (int m = 0; m < 3; m++)
+    {
+        Yin<T> yin (fs);
+        yin.setDifferenceMethod (methods[m]);
+        yin.setHopSize (hopSize);
+        
+        BenchmarkTimer timer;
+        
+        for (int repeat = 0; repeat < numRepeats; repeat++)
+        {
+            yin.resetIncrementalDifference();
+            
+            for (int frame = 0; frame < numFrames; frame++)
+                checksum += yin.pitchYin (signal.data() + frame * hopSize, frameSize);
+        }
+        
+        printf ("%-14s %16.2f\n", methodNames[m], timer.getElapsedMicroseconds() / (numFrames * numRepeats));
+    }
+    
+    printf ("(checksum %g)\n", (double)checksum);
+}
+
+//=======================================================================
+template <class T>
+void benchmarkMultirate (const char* precisionName)
+{
+    const int frameSizes[] = {1024, 2048, 4096};
+    T checksum = 0;
+    
+    printf ("\n%s precision, direct method\n", precisionName);
+    printf ("%-12s %14s %14s %14s\n", "frame size", "full (us)", "factor 2 (us)", "factor 4 (us)");
+    
+    for (int frameSize : frameSizes)
+    {
+        std::vector<T> frame = createPitchedFrame<T> (frameSize, 220, 44100);
+        const int numIterations = std::max (20, 200000000 / (frameSize * frameSize));
+        double times[3];
+        
+        for (int i = 0; i < 3; i++)
+        {
+            Yin<T> yin (44100);
+            yin.setEarlyExit (false);
+            yin.setDecimationFactor (1 << i);
+            checksum += timeYin (yin, frame, numIterations, times[i]);
+        }
+        
+        printf ("%-12d %14.2f %14.2f %14.2f\n", frameSize, times[0], times[1], times[2]);
+    }
+    
+    printf ("(checksum %g)\n", (double)checksum);
+}
+
+//=======================================================================
+int main()
+{
+    benchmarkPitch<float> ("single");
+    benchmarkPitch<double> ("double");
+    
+    benchmarkSearchRange<float> ("single");
+    
+    benchmarkOverlappingFrames<float> ("single");
+    benchmarkOverlappingFrames<double> ("double");
+    
+    benchmarkMultirate<float> ("single");
+    
+    return 0;
+}
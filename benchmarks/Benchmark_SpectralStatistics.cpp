@@ -0,0 +1,68 @@
+//=======================================================================
+/** @file Benchmark_SpectralStatistics.cpp
+ *  @brief Compares the five spectral feature functions with the fused calculateStatistics()
+ */
+//=======================================================================
+
+#include <CoreFrequencyDomainFeatures.h>
+#include <cstdio>
+#include "BenchmarkUtilities.h"
+
+//=======================================================================
+template <class T>
+void benchmarkSpectralStatistics (const char* precisionName)
+{
+    const int spectrumSizes[] = {128, 256, 512, 1024, 2048};
+    T checksum = 0;
+    
+    printf ("\n%s precision\n", precisionName);
+    printf ("%-14s %18s %14s %10s\n", "spectrum size", "individual (us)", "fused (us)", "speedup");
+    
+    for (int spectrumSize : spectrumSizes)
+    {
+        std::vector<T> spectrum = createNoiseFrame<T> (spectrumSize);
+        
+        for (T& v : spectrum)
+            v = v < 0 ? -v * 20 : v * 20;
+        
+        const int numIterations = 20000000 / spectrumSize;
+        CoreFrequencyDomainFeatures<T> fdf;
+        
+        BenchmarkTimer individualTimer;
+        
+        for (int i = 0; i < numIterations; i++)
+        {
+            checksum += fdf.spectralCentroid (spectrum);
+            checksum += fdf.spectralCrest (spectrum);
+            checksum += fdf.spectralFlatness (spectrum);
+            checksum += fdf.spectralRolloff (spectrum);
+            checksum += fdf.spectralKurtosis (spectrum);
+        }
+        
+        double individualTime = individualTimer.getElapsedMicroseconds() / numIterations;
+        
+        BenchmarkTimer fusedTimer;
+        
+        for (int i = 0; i < numIterations; i++)
+        {
+            typename CoreFrequencyDomainFeatures<T>::Statistics statistics = fdf.calculateStatistics (spectrum);
+            checksum += statistics.spectralCentroid + statistics.spectralCrest + statistics.spectralFlatness
+                      + statistics.spectralRolloff + statistics.spectralKurtosis;
+        }
+        
+        double fusedTime = fusedTimer.getElapsedMicroseconds() / numIterations;
+        
+        printf ("%-14d %18.3f %14.3f %10.2f\n", spectrumSize, individualTime, fusedTime, individualTime / fusedTime);
+    }
+    
+    printf ("(checksum %g)\n", (double)checksum);
+}
+
+//=======================================================================
+int main()
+{
+    benchmarkSpectralStatistics<float> ("single");
+    benchmarkSpectralStatistics<double> ("double");
+    
+    return 0;
+}
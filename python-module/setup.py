@@ -17,6 +17,14 @@ name = 'gist'
 sources = [
 'GistPythonModule.cpp',
 '../src/Gist.cpp',
+'../src/GistPlan.cpp',
+'../src/FFTEngine.cpp',
+'../src/FFTWFFT.cpp',
+'../src/KissFFT.cpp',
+'../src/SimdFFT.cpp',
+'../src/FFTPlanCache.cpp',
+'../src/AlignedArena.cpp',
+'../src/SimdKernels.cpp',
 '../src/core/CoreFrequencyDomainFeatures.cpp',
 '../src/core/CoreTimeDomainFeatures.cpp',
 '../src/mfcc/MFCC.cpp',
@@ -26,11 +34,11 @@ sources = [
 ]
 
 include_dirs = [
-                numpy.get_include(),'/usr/local/include'
+                numpy.get_include(),'/usr/local/include','../libs/kiss_fft130'
                 ]
 
 setup( name = 'Gist',
       include_dirs = include_dirs,
-      ext_modules = [Extension(name, sources,libraries = ['fftw3'],library_dirs = ['/usr/local/lib'],define_macros=[
+      ext_modules = [Extension(name, sources,libraries = ['fftw3', 'fftw3f'],library_dirs = ['/usr/local/lib'],define_macros=[
                          ('USE_FFTW', None)],)]
       )
\ No newline at end of file
@@ -51,13 +51,22 @@ void AccelerateFFT<float>::setAudioFrameSize (int frameSize)
     {
         free (complexSplit.realp);
         free (complexSplit.imagp);
-        vDSP_destroy_fftsetup (fftSetupFloat);
     }
     
-    complexSplit.realp = (float*)malloc (fftSize * sizeof (float));
-    complexSplit.imagp = (float*)malloc (fftSize * sizeof (float));
-        
-    fftSetupFloat = vDSP_create_fftsetup (log2n, FFT_RADIX2);
+    complexSplit.realp = (float*)malloc ((fftSizeOver2 + 1) * sizeof (float));
+    complexSplit.imagp = (float*)malloc ((fftSizeOver2 + 1) * sizeof (float));
+    
+    FFTPlanCache::PlanKey key (AccelerateFFTBackend, (int)fftSize, sizeof (float), ForwardFFT);
+    vDSP_Length setupLog2n = log2n;
+    
+    fftSetupFloat = FFTPlanCache::getPlan<OpaqueFFTSetup> (key, [setupLog2n]()
+    {
+        return vDSP_create_fftsetup (setupLog2n, FFT_RADIX2);
+    },
+    [] (FFTSetup setup)
+    {
+        vDSP_destroy_fftsetup (setup);
+    });
     
     if (fftSetupFloat == nullptr)
     {
@@ -80,13 +89,22 @@ void AccelerateFFT<double>::setAudioFrameSize (int frameSize)
     {
         free (doubleComplexSplit.realp);
         free (doubleComplexSplit.imagp);
-        vDSP_destroy_fftsetupD (fftSetupDouble);
     }
     
-    doubleComplexSplit.realp = (double*)malloc (fftSize * sizeof (double));
-    doubleComplexSplit.imagp = (double*)malloc (fftSize * sizeof (double));
+    doubleComplexSplit.realp = (double*)malloc ((fftSizeOver2 + 1) * sizeof (double));
+    doubleComplexSplit.imagp = (double*)malloc ((fftSizeOver2 + 1) * sizeof (double));
     
-    fftSetupDouble = vDSP_create_fftsetupD (log2n, FFT_RADIX2);
+    FFTPlanCache::PlanKey key (AccelerateFFTBackend, (int)fftSize, sizeof (double), ForwardFFT);
+    vDSP_Length setupLog2n = log2n;
+    
+    fftSetupDouble = FFTPlanCache::getPlan<OpaqueFFTSetupD> (key, [setupLog2n]()
+    {
+        return vDSP_create_fftsetupD (setupLog2n, FFT_RADIX2);
+    },
+    [] (FFTSetupD setup)
+    {
+        vDSP_destroy_fftsetupD (setup);
+    });
     
     if (fftSetupDouble == nullptr)
     {
@@ -103,7 +121,6 @@ AccelerateFFT<float>::~AccelerateFFT()
 {
     free (complexSplit.realp);
     free (complexSplit.imagp);
-    vDSP_destroy_fftsetup (fftSetupFloat);
 }
 
 //=======================================================================
@@ -112,15 +129,14 @@ AccelerateFFT<double>::~AccelerateFFT()
 {
     free (doubleComplexSplit.realp);
     free (doubleComplexSplit.imagp);
-    vDSP_destroy_fftsetupD (fftSetupDouble);
 }
 
 //=======================================================================
 template <>
-void AccelerateFFT<float>::performFFT (float* buffer, float* real, float* imag)
+void AccelerateFFT<float>::performFFT (const float* buffer, float* real, float* imag)
 {
-    vDSP_ctoz ((COMPLEX*)buffer, 2, &complexSplit, 1, fftSizeOver2);
-    vDSP_fft_zrip (fftSetupFloat, &complexSplit, 1, log2n, FFT_FORWARD);
+    vDSP_ctoz ((const COMPLEX*)buffer, 2, &complexSplit, 1, fftSizeOver2);
+    vDSP_fft_zrip (fftSetupFloat.get(), &complexSplit, 1, log2n, FFT_FORWARD);
     
     complexSplit.realp[fftSizeOver2] = complexSplit.imagp[0];
     complexSplit.imagp[fftSizeOver2] = 0.0;
@@ -132,13 +148,7 @@ void AccelerateFFT<float>::performFFT (float* buffer, float* real, float* imag)
         complexSplit.imagp[i] *= 0.5;
     }
     
-    for (size_t i = fftSizeOver2 - 1; i > 0; --i)
-    {
-        complexSplit.realp[2 * fftSizeOver2 - i] = complexSplit.realp[i];
-        complexSplit.imagp[2 * fftSizeOver2 - i] = -1 * complexSplit.imagp[i];
-    }
-    
-    for (size_t i = 0; i < fftSize; i++)
+    for (size_t i = 0; i <= fftSizeOver2; i++)
     {
         real[i] = complexSplit.realp[i];
         imag[i] = complexSplit.imagp[i];
@@ -147,10 +157,10 @@ void AccelerateFFT<float>::performFFT (float* buffer, float* real, float* imag)
 
 //=======================================================================
 template <>
-void AccelerateFFT<double>::performFFT (double* buffer, double* real, double* imag)
+void AccelerateFFT<double>::performFFT (const double* buffer, double* real, double* imag)
 {
-    vDSP_ctozD ((DOUBLE_COMPLEX*)buffer, 2, &doubleComplexSplit, 1, fftSizeOver2);
-    vDSP_fft_zripD (fftSetupDouble, &doubleComplexSplit, 1, log2n, FFT_FORWARD);
+    vDSP_ctozD ((const DOUBLE_COMPLEX*)buffer, 2, &doubleComplexSplit, 1, fftSizeOver2);
+    vDSP_fft_zripD (fftSetupDouble.get(), &doubleComplexSplit, 1, log2n, FFT_FORWARD);
     
     doubleComplexSplit.realp[fftSizeOver2] = doubleComplexSplit.imagp[0];
     doubleComplexSplit.imagp[fftSizeOver2] = 0.0;
@@ -162,13 +172,7 @@ void AccelerateFFT<double>::performFFT (double* buffer, double* real, double* im
         doubleComplexSplit.imagp[i] *= 0.5;
     }
     
-    for (size_t i = fftSizeOver2 - 1; i > 0; --i)
-    {
-        doubleComplexSplit.realp[2 * fftSizeOver2 - i] = doubleComplexSplit.realp[i];
-        doubleComplexSplit.imagp[2 * fftSizeOver2 - i] = -1 * doubleComplexSplit.imagp[i];
-    }
-    
-    for (size_t i = 0; i < fftSize; i++)
+    for (size_t i = 0; i <= fftSizeOver2; i++)
     {
         real[i] = doubleComplexSplit.realp[i];
         imag[i] = doubleComplexSplit.imagp[i];
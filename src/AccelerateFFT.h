@@ -30,11 +30,16 @@
 #define VIMAGE_H
 
 #include <Accelerate/Accelerate.h>
+#include <memory>
+#include "FFTPlanCache.h"
+#include "FFTEngine.h"
 
 //===========================================================
-/** Performs the FFT using the Apple Accelerate Framework */
+/** Performs the FFT using the Apple Accelerate Framework. The vDSP FFT setups
+ * are shared between all AccelerateFFT objects of the same size through the
+ * FFTPlanCache */
 template <class T>
-class AccelerateFFT
+class AccelerateFFT : public FFTEngine<T>
 {
 public:
     
@@ -44,10 +49,17 @@ public:
     
     //===========================================================
     /** Sets the audio frame size to be used in the FFT */
-    void setAudioFrameSize (int frameSize);
+    void setAudioFrameSize (int frameSize) override;
     
-    /** Performs the FFT using Apple Accelerate FFT */
-    void performFFT (T* buffer, T* real, T* imag);
+    /** Performs the FFT using Apple Accelerate FFT
+     * @param buffer the real-valued input frame
+     * @param real the real part of the non-redundant bins (fftSize / 2 + 1 values)
+     * @param imag the imaginary part of the non-redundant bins (fftSize / 2 + 1 values)
+     */
+    void performFFT (const T* buffer, T* real, T* imag) override;
+
+    /** @Returns the backend implementing this engine */
+    FFTBackend getBackend() const override { return AccelerateFFTBackend; }
     
 private:
     
@@ -55,8 +67,8 @@ private:
     size_t fftSizeOver2;
     size_t log2n;
     
-    FFTSetup fftSetupFloat;
-    FFTSetupD fftSetupDouble;
+    std::shared_ptr<OpaqueFFTSetup> fftSetupFloat;
+    std::shared_ptr<OpaqueFFTSetupD> fftSetupDouble;
     COMPLEX_SPLIT complexSplit;
     DOUBLE_COMPLEX_SPLIT doubleComplexSplit;
     
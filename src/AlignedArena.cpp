@@ -0,0 +1,112 @@
+//=======================================================================
+/** @file AlignedArena.cpp
+ *  @brief A single block of cache-line aligned memory holding several buffers
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#include "AlignedArena.h"
+#include <algorithm>
+#include <new>
+#include <stdlib.h>
+
+#if defined (_MSC_VER)
+#include <malloc.h>
+#endif
+
+//=======================================================================
+template <class T>
+AlignedArena<T>::AlignedArena()
+ :  memory (nullptr),
+    capacity (0),
+    numValues (0)
+{
+}
+
+//=======================================================================
+template <class T>
+AlignedArena<T>::~AlignedArena()
+{
+    release();
+}
+
+//=======================================================================
+template <class T>
+void AlignedArena<T>::clear()
+{
+    numValues = 0;
+}
+
+//=======================================================================
+template <class T>
+size_t AlignedArena<T>::addBuffer (size_t numValuesInBuffer)
+{
+    const size_t valuesPerAlignment = alignment / sizeof (T);
+    const size_t offset = numValues;
+
+    // round up so that the next buffer starts on a boundary too
+    numValues += ((numValuesInBuffer + valuesPerAlignment - 1) / valuesPerAlignment) * valuesPerAlignment;
+
+    return offset;
+}
+
+//=======================================================================
+template <class T>
+void AlignedArena<T>::allocate()
+{
+    if (numValues > capacity)
+    {
+        release();
+
+        void* newMemory = nullptr;
+
+#if defined (_MSC_VER)
+        newMemory = _aligned_malloc (numValues * sizeof (T), alignment);
+#else
+        if (posix_memalign (&newMemory, alignment, numValues * sizeof (T)) != 0)
+            newMemory = nullptr;
+#endif
+
+        if (newMemory == nullptr)
+            throw std::bad_alloc();
+
+        memory = static_cast<T*> (newMemory);
+        capacity = numValues;
+    }
+
+    std::fill (memory, memory + numValues, (T)0);
+}
+
+//=======================================================================
+template <class T>
+void AlignedArena<T>::release()
+{
+#if defined (_MSC_VER)
+    _aligned_free (memory);
+#else
+    free (memory);
+#endif
+
+    memory = nullptr;
+    capacity = 0;
+}
+
+//===========================================================
+template class AlignedArena<float>;
+template class AlignedArena<double>;
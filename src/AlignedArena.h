@@ -0,0 +1,100 @@
+//=======================================================================
+/** @file AlignedArena.h
+ *  @brief A single block of cache-line aligned memory holding several buffers
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __AlignedArena__
+#define __AlignedArena__
+
+#include <cstddef>
+
+//=======================================================================
+/** One allocation holding a number of buffers back to back, each starting
+ * on a 64 byte boundary. A 64 byte boundary is both a cache line and the width
+ * of the widest vector registers, so no SIMD load of a buffer straddles two lines
+ * and the buffers of one object sit together in memory rather than wherever
+ * the allocator happened to put them.
+ *
+ * The buffers are laid out with addBuffer() and the memory allocated with
+ * allocate(), after which getBuffer() returns a pointer to each:
+ *
+ *     arena.clear();
+ *     size_t frameOffset = arena.addBuffer (frameSize);
+ *     size_t spectrumOffset = arena.addBuffer (frameSize / 2 + 1);
+ *     arena.allocate();
+ *     T* frame = arena.getBuffer (frameOffset);
+ *
+ * Instantiations of the class should be of either 'float' or 'double' types and no others
+ */
+template <class T>
+class AlignedArena
+{
+public:
+
+    //=======================================================================
+    /** The alignment of every buffer, in bytes */
+    static const size_t alignment = 64;
+
+    //=======================================================================
+    /** Constructor (allocates nothing) */
+    AlignedArena();
+
+    /** Destructor */
+    ~AlignedArena();
+
+    AlignedArena (const AlignedArena&) = delete;
+    AlignedArena& operator= (const AlignedArena&) = delete;
+
+    //=======================================================================
+    /** Forgets the buffers laid out so far. The memory is kept until the next allocate() */
+    void clear();
+
+    /** Lays out a buffer after the ones added since the last clear()
+     * @param numValues the number of values in the buffer
+     * @returns the offset of the buffer, to pass to getBuffer() once allocate() has been called
+     */
+    size_t addBuffer (size_t numValues);
+
+    /** Allocates memory for the buffers laid out, filled with zeros. The memory is only
+     * reallocated if it is too small, so pointers from before the call should be fetched again */
+    void allocate();
+
+    //=======================================================================
+    /** @returns a pointer to a buffer
+     * @param offset the offset returned by addBuffer()
+     */
+    T* getBuffer (size_t offset) { return memory + offset; }
+
+    /** @returns the number of values the buffers laid out take, including the padding between them */
+    size_t getSize() const { return numValues; }
+
+private:
+
+    //=======================================================================
+    /** Frees the memory */
+    void release();
+
+    T* memory;          /**< The memory holding the buffers */
+    size_t capacity;    /**< The number of values the memory has room for */
+    size_t numValues;   /**< The number of values taken by the buffers laid out */
+};
+
+#endif /* __AlignedArena__ */
@@ -22,6 +22,8 @@
 //=======================================================================
 
 #include "CoreFrequencyDomainFeatures.h"
+#include "SimdKernels.h"
+#include <algorithm>
 
 //===========================================================
 template <class T>
@@ -125,11 +127,35 @@ T CoreFrequencyDomainFeatures<T>::spectralCrest (const std::vector<T>& magnitude
     return spectralCrest;
 }
 
+//===========================================================
+template <class T>
+T CoreFrequencyDomainFeatures<T>::spectralCrestFromPowerSpectrum (const std::vector<T>& powerSpectrum)
+{
+    T sumVal = 0.0;
+    T maxVal = 0.0;
+    T N = (T)powerSpectrum.size();
+
+    for (size_t i = 0; i < powerSpectrum.size(); i++)
+    {
+        T v = powerSpectrum[i];
+        sumVal += v;
+
+        if (v > maxVal)
+            maxVal = v;
+    }
+
+    // this is a ratio so we return 1.0 if the buffer is just zeros
+    if (sumVal > 0)
+        return maxVal / (sumVal / N);
+    else
+        return 1.0;
+}
+
 //===========================================================
 template <class T>
 T CoreFrequencyDomainFeatures<T>::spectralRolloff (const std::vector<T>& magnitudeSpectrum, T percentile)
 {
-    T sumOfMagnitudeSpectrum = std::accumulate (magnitudeSpectrum.begin(), magnitudeSpectrum.end(), 0);
+    T sumOfMagnitudeSpectrum = std::accumulate (magnitudeSpectrum.begin(), magnitudeSpectrum.end(), (T)0);
     T threshold = sumOfMagnitudeSpectrum * percentile;
     
     T cumulativeSum = 0;
@@ -157,7 +183,7 @@ T CoreFrequencyDomainFeatures<T>::spectralKurtosis (const std::vector<T>& magnit
 {
     // https://en.wikipedia.org/wiki/Kurtosis#Sample_kurtosis
     
-    T sumOfMagnitudeSpectrum = std::accumulate (magnitudeSpectrum.begin(), magnitudeSpectrum.end(), 0);
+    T sumOfMagnitudeSpectrum = std::accumulate (magnitudeSpectrum.begin(), magnitudeSpectrum.end(), (T)0);
     
     T mean = sumOfMagnitudeSpectrum / (T)magnitudeSpectrum.size();
     
@@ -186,6 +212,136 @@ T CoreFrequencyDomainFeatures<T>::spectralKurtosis (const std::vector<T>& magnit
     }
 }
 
+//===========================================================
+template <class T>
+typename CoreFrequencyDomainFeatures<T>::Statistics CoreFrequencyDomainFeatures<T>::calculateStatistics (const std::vector<T>& magnitudeSpectrum, T rolloffPercentile)
+{
+    const SimdKernels<T>& kernels = SimdKernels<T>::get();
+    
+    // few enough values of at least one that their product only overflows a double for magnitudes beyond about 1e38
+    const int blockSize = 8;
+    
+    const T* spectrum = magnitudeSpectrum.data();
+    const size_t numBins = magnitudeSpectrum.size();
+    const size_t numFullBlocks = numBins / blockSize;
+    const size_t numBlocks = (numBins + blockSize - 1) / blockSize;
+    const T N = (T)numBins;
+    
+    blockSums.resize (numBlocks);
+    
+    //-----------------------------------------------------------
+    // first pass: the sums behind the centroid and crest...
+    T sums[4];
+    kernels.spectralSums (spectrum, numBins, sums);
+    
+    const T totalSum = sums[0];
+    const T totalWeightedSum = sums[1];
+    const T totalSumOfSquares = sums[2];
+    const T maxSquaredValue = sums[3];
+    
+    // ...and the logs for the flatness (one per block of bins rather than one per bin), with the block sums for the rolloff
+    double logSum = 0.0;
+    
+    for (size_t b = 0; b < numFullBlocks; b++)
+    {
+        const T* block = spectrum + b * blockSize;
+        double product = 1.0;
+        T blockSum = 0;
+        
+        for (int j = 0; j < blockSize; j++)
+        {
+            product *= 1.0 + (double)block[j];
+            blockSum += block[j];
+        }
+        
+        if (product < DBL_MAX)
+        {
+            logSum += log (product);
+        }
+        else
+        {
+            for (int j = 0; j < blockSize; j++)
+                logSum += log (1.0 + (double)block[j]);
+        }
+        
+        blockSums[b] = blockSum;
+    }
+    
+    // the bins left over after the last full block
+    if (numBlocks > numFullBlocks)
+    {
+        T blockSum = 0;
+        
+        for (size_t i = numFullBlocks * blockSize; i < numBins; i++)
+        {
+            logSum += log (1.0 + (double)spectrum[i]);
+            blockSum += spectrum[i];
+        }
+        
+        blockSums[numFullBlocks] = blockSum;
+    }
+    
+    Statistics statistics;
+    
+    statistics.spectralCentroid = totalSum > 0 ? totalWeightedSum / totalSum : 0;
+    statistics.spectralCrest = totalSumOfSquares > 0 ? maxSquaredValue / (totalSumOfSquares / N) : 1;
+    statistics.spectralFlatness = (T)(exp (logSum / (double)numBins) / (((double)numBins + (double)totalSum) / (double)numBins));
+    
+    //-----------------------------------------------------------
+    // the rolloff: skip whole blocks until the one where the cumulative sum crosses the threshold
+    T sumOfBlockSums = 0;
+    
+    for (size_t b = 0; b < numBlocks; b++)
+        sumOfBlockSums += blockSums[b];
+    
+    T threshold = sumOfBlockSums * rolloffPercentile;
+    T cumulativeSum = 0;
+    int rolloffIndex = 0;
+    bool rolloffFound = false;
+    
+    for (size_t b = 0; b < numBlocks && ! rolloffFound; b++)
+    {
+        if (cumulativeSum + blockSums[b] <= threshold)
+        {
+            cumulativeSum += blockSums[b];
+            continue;
+        }
+        
+        size_t blockEnd = std::min ((b + 1) * blockSize, numBins);
+        
+        for (size_t i = b * blockSize; i < blockEnd; i++)
+        {
+            cumulativeSum += spectrum[i];
+            
+            if (cumulativeSum > threshold)
+            {
+                rolloffIndex = static_cast<int> (i);
+                rolloffFound = true;
+                break;
+            }
+        }
+    }
+    
+    statistics.spectralRolloff = ((T)rolloffIndex) / N;
+    
+    //-----------------------------------------------------------
+    // second pass: the central moments for the kurtosis
+    const T mean = totalSum / N;
+    
+    T moments[2];
+    kernels.centralMoments (spectrum, numBins, mean, moments);
+    
+    T moment2 = moments[0];
+    T moment4 = moments[1];
+    
+    moment2 = moment2 / N;
+    moment4 = moment4 / N;
+    
+    statistics.spectralKurtosis = moment2 == 0 ? -3 : (moment4 / (moment2 * moment2)) - 3;
+    
+    return statistics;
+}
+
 //===========================================================
 template class CoreFrequencyDomainFeatures<float>;
 template class CoreFrequencyDomainFeatures<double>;
@@ -27,6 +27,7 @@
 #include <vector>
 #include <numeric>
 #include <math.h>
+#include <float.h>
 
 /** template class for calculating common frequency domain
  * audio features. Instantiations of the class should be
@@ -62,6 +63,13 @@ public:
      @returns the spectral crest
      */
     T spectralCrest (const std::vector<T>& magnitudeSpectrum);
+
+    /** calculates the spectral crest from the power spectrum (the squared magnitude
+     spectrum), which is what the spectral crest is measured on.
+     @param powerSpectrum the first half of the power spectrum (i.e. not mirrored)
+     @returns the spectral crest
+     */
+    T spectralCrestFromPowerSpectrum (const std::vector<T>& powerSpectrum);
     
     //===========================================================
     /** calculates the spectral rolloff given the first half of the magnitude spectrum
@@ -80,7 +88,30 @@ public:
      */
     T spectralKurtosis (const std::vector<T>& magnitudeSpectrum);
     
+    //===========================================================
+    /** the core frequency domain features of a magnitude spectrum, calculated together */
+    struct Statistics
+    {
+        T spectralCentroid;     /**< as returned by spectralCentroid() */
+        T spectralCrest;        /**< as returned by spectralCrest() */
+        T spectralFlatness;     /**< as returned by spectralFlatness() */
+        T spectralRolloff;      /**< as returned by spectralRolloff() */
+        T spectralKurtosis;     /**< as returned by spectralKurtosis() */
+    };
+    
+    /** calculates the spectral centroid, crest, flatness, rolloff and kurtosis together. The sums they
+     are derived from are gathered in one vectorised pass over the spectrum (taking one log per block of
+     bins for the flatness rather than one per bin), followed by a second pass for the central moments
+     needed by the kurtosis. This is several times faster than calling the five functions separately.
+     @param magnitudeSpectrum the first half of the magnitude spectrum (i.e. not mirrored)
+     @param rolloffPercentile the rolloff threshold
+     @returns the statistics of the magnitude spectrum
+     */
+    Statistics calculateStatistics (const std::vector<T>& magnitudeSpectrum, T rolloffPercentile = 0.85);
     
+private:
+    /** the sum of each block of bins, used to find the rolloff without another full pass */
+    std::vector<T> blockSums;
 };
 
 #endif
@@ -22,6 +22,7 @@
 //=======================================================================
 
 #include "CoreTimeDomainFeatures.h"
+#include "SimdKernels.h"
 
 //===========================================================
 template <class T>
@@ -33,69 +34,70 @@ CoreTimeDomainFeatures<T>::CoreTimeDomainFeatures()
 template <class T>
 T CoreTimeDomainFeatures<T>::rootMeanSquare (const std::vector<T>& buffer)
 {
-    // create variable to hold the sum
-    T sum = 0;
-
-    // sum the squared samples
-    for (size_t i = 0; i < buffer.size(); i++)
-    {
-        sum += pow (buffer[i], 2);
-    }
+    return rootMeanSquare (buffer.data(), buffer.size());
+}
 
-    // return the square root of the mean of squared samples
-    return sqrt (sum / ((T)buffer.size()));
+//===========================================================
+template <class T>
+T CoreTimeDomainFeatures<T>::rootMeanSquare (const T* buffer, size_t numSamples)
+{
+    return calculateStatistics (buffer, numSamples).rootMeanSquare;
 }
 
 //===========================================================
 template <class T>
 T CoreTimeDomainFeatures<T>::peakEnergy (const std::vector<T>& buffer)
 {
-    // create variable with very small value to hold the peak value
-    T peak = -10000.0;
-
-    // for each audio sample
-    for (size_t i = 0; i < buffer.size(); i++)
-    {
-        // store the absolute value of the sample
-        T absSample = fabs (buffer[i]);
-
-        // if the absolute value is larger than the peak
-        if (absSample > peak)
-        {
-            // the peak takes on the sample value
-            peak = absSample;
-        }
-    }
+    return peakEnergy (buffer.data(), buffer.size());
+}
 
-    // return the peak value
-    return peak;
+//===========================================================
+template <class T>
+T CoreTimeDomainFeatures<T>::peakEnergy (const T* buffer, size_t numSamples)
+{
+    return calculateStatistics (buffer, numSamples).peakEnergy;
 }
 
 //===========================================================
 template <class T>
 T CoreTimeDomainFeatures<T>::zeroCrossingRate (const std::vector<T>& buffer)
 {
-    // create a variable to hold the zero crossing rate
-    T zcr = 0;
+    return zeroCrossingRate (buffer.data(), buffer.size());
+}
 
-    // for each audio sample, starting from the second one
-    for (size_t i = 1; i < buffer.size(); i++)
-    {
-        // initialise two booleans indicating whether or not
-        // the current and previous sample are positive
-        bool current = (buffer[i] > 0);
-        bool previous = (buffer[i - 1] > 0);
+//===========================================================
+template <class T>
+T CoreTimeDomainFeatures<T>::zeroCrossingRate (const T* buffer, size_t numSamples)
+{
+    return calculateStatistics (buffer, numSamples).zeroCrossingRate;
+}
 
-        // if the sign is different
-        if (current != previous)
-        {
-            // add one to the zero crossing rate
-            zcr = zcr + 1.0;
-        }
-    }
+//===========================================================
+template <class T>
+typename CoreTimeDomainFeatures<T>::Statistics CoreTimeDomainFeatures<T>::calculateStatistics (const std::vector<T>& buffer)
+{
+    return calculateStatistics (buffer.data(), buffer.size());
+}
 
-    // return the zero crossing rate
-    return zcr;
+//===========================================================
+template <class T>
+typename CoreTimeDomainFeatures<T>::Statistics CoreTimeDomainFeatures<T>::calculateStatistics (const T* buffer, size_t numSamples)
+{
+    Statistics statistics = {0, 0, 0, 0};
+    
+    if (numSamples == 0)
+        return statistics;
+    
+    // the energy, peak and number of zero crossings
+    T values[3];
+    SimdKernels<T>::get().timeDomainStatistics (buffer, numSamples, values);
+    
+    statistics.energy = values[0];
+    statistics.rootMeanSquare = sqrt (values[0] / ((T)numSamples));
+    statistics.peakEnergy = values[1];
+    statistics.zeroCrossingRate = values[2];
+    
+    return statistics;
 }
 
 //===========================================================
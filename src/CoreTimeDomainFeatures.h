@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <math.h>
+#include <stddef.h>
 
 /** template class for calculating common time domain
  * audio features. Instantiations of the class should be
@@ -45,6 +46,13 @@ public:
      */
     T rootMeanSquare (const std::vector<T>& buffer);
 
+    /** calculates the Root Mean Square (RMS) of an audio buffer
+     * @param buffer a pointer to the audio samples
+     * @param numSamples the number of samples in the buffer
+     * @returns the RMS value
+     */
+    T rootMeanSquare (const T* buffer, size_t numSamples);
+
     //===========================================================
     /** calculates the peak energy (max absolute value) in a time
      * domain audio signal buffer in vector format
@@ -53,12 +61,54 @@ public:
      */
     T peakEnergy (const std::vector<T>& buffer);
 
+    /** calculates the peak energy (max absolute value) in a time
+     * domain audio signal buffer
+     * @param buffer a pointer to the audio samples
+     * @param numSamples the number of samples in the buffer
+     * @returns the peak energy value
+     */
+    T peakEnergy (const T* buffer, size_t numSamples);
+
     //===========================================================
     /** calculates the zero crossing rate of a time domain audio signal buffer
      * @param buffer a time domain buffer containing audio samples
      * @returns the zero crossing rate
      */
     T zeroCrossingRate (const std::vector<T>& buffer);
+
+    /** calculates the zero crossing rate of a time domain audio signal buffer
+     * @param buffer a pointer to the audio samples
+     * @param numSamples the number of samples in the buffer
+     * @returns the zero crossing rate
+     */
+    T zeroCrossingRate (const T* buffer, size_t numSamples);
+
+    //===========================================================
+    /** the core time domain features of a buffer, calculated together */
+    struct Statistics
+    {
+        T energy;           /**< the sum of the squared samples */
+        T rootMeanSquare;   /**< as returned by rootMeanSquare() */
+        T peakEnergy;       /**< as returned by peakEnergy() */
+        T zeroCrossingRate; /**< as returned by zeroCrossingRate() */
+    };
+
+    /** calculates the energy, RMS, peak energy and zero crossing rate of a
+     * time domain audio signal buffer in a single pass over the samples
+     * @param buffer a time domain buffer containing audio samples
+     * @returns the statistics of the buffer
+     */
+    Statistics calculateStatistics (const std::vector<T>& buffer);
+
+    /** calculates the energy, RMS, peak energy and zero crossing rate of a
+     * time domain audio signal buffer in a single pass over the samples, a vector
+     * of samples at a time. rootMeanSquare(), peakEnergy() and zeroCrossingRate()
+     * are taken from this, so they agree exactly with it
+     * @param buffer a pointer to the audio samples
+     * @param numSamples the number of samples in the buffer
+     * @returns the statistics of the buffer
+     */
+    Statistics calculateStatistics (const T* buffer, size_t numSamples);
 };
 
 #endif
@@ -0,0 +1,186 @@
+//=======================================================================
+/** @file FFTEngine.cpp
+ *  @brief The interface shared by all FFT backends, and the choice between them
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#include "FFTEngine.h"
+#include "KissFFT.h"
+#include "SimdFFT.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef USE_FFTW
+#include "FFTWFFT.h"
+#endif
+
+#ifdef USE_ACCELERATE_FFT
+#include "AccelerateFFT.h"
+#endif
+
+//=======================================================================
+template <class T>
+std::unique_ptr<FFTEngine<T>> FFTEngine<T>::create (FFTBackend backend)
+{
+    switch (backend)
+    {
+        case KissFFTBackend:
+            return std::unique_ptr<FFTEngine<T>> (new KissFFT<T>());
+
+        case SimdFFTBackend:
+            return std::unique_ptr<FFTEngine<T>> (new SimdFFT<T>());
+
+#ifdef USE_FFTW
+        case FFTWBackend:
+            return std::unique_ptr<FFTEngine<T>> (new FFTWFFT<T>());
+#endif
+
+#ifdef USE_ACCELERATE_FFT
+        case AccelerateFFTBackend:
+            return std::unique_ptr<FFTEngine<T>> (new AccelerateFFT<T>());
+#endif
+
+        default:
+            return nullptr;
+    }
+}
+
+//=======================================================================
+template <class T>
+bool FFTEngine<T>::isBackendAvailable (FFTBackend backend, int frameSize)
+{
+    switch (backend)
+    {
+        case KissFFTBackend:
+        case SimdFFTBackend:
+            return true;
+
+#ifdef USE_FFTW
+        case FFTWBackend:
+            return true;
+#endif
+
+#ifdef USE_ACCELERATE_FFT
+        case AccelerateFFTBackend:
+            // vDSP's real FFT only handles powers of two
+            return frameSize >= 2 && (frameSize & (frameSize - 1)) == 0;
+#endif
+
+        default:
+            (void)frameSize;
+            return false;
+    }
+}
+
+//=======================================================================
+template <class T>
+FFTBackend FFTEngine<T>::resolveBackend (FFTBackend requestedBackend, int frameSize)
+{
+    if (requestedBackend == AutomaticFFTBackend)
+        return findFastestBackend (frameSize);
+
+    if (requestedBackend != DefaultFFTBackend && isBackendAvailable (requestedBackend, frameSize))
+        return requestedBackend;
+
+    if (isBackendAvailable (AccelerateFFTBackend, frameSize))
+        return AccelerateFFTBackend;
+
+    if (isBackendAvailable (FFTWBackend, frameSize))
+        return FFTWBackend;
+
+#ifdef USE_KISS_FFT
+    return KissFFTBackend;
+#else
+    return SimdFFTBackend;
+#endif
+}
+
+//=======================================================================
+template <class T>
+FFTBackend FFTEngine<T>::findFastestBackend (int frameSize)
+{
+    static std::mutex mutex;
+    static std::map<int, FFTBackend> fastestBackends;
+
+    // the lock is held while measuring so that concurrent callers wait for
+    // one measurement instead of all timing the backends against each other
+    std::lock_guard<std::mutex> lock (mutex);
+
+    auto it = fastestBackends.find (frameSize);
+
+    if (it != fastestBackends.end())
+        return it->second;
+
+    const FFTBackend candidates[] = {KissFFTBackend, SimdFFTBackend, FFTWBackend, AccelerateFFTBackend};
+    const int numTrials = 3;
+    const int numFramesPerTrial = 16 + (1 << 18) / (frameSize > 0 ? frameSize : 1);
+
+    std::vector<T> frame (frameSize);
+    std::vector<T> real (frameSize / 2 + 1);
+    std::vector<T> imag (frameSize / 2 + 1);
+
+    for (int i = 0; i < frameSize; i++)
+        frame[i] = (T)(((i * 7919) % 1000) - 500) / (T)1000.;
+
+    FFTBackend fastestBackend = resolveBackend (DefaultFFTBackend, frameSize);
+    double fastestTime = -1;
+
+    for (FFTBackend backend : candidates)
+    {
+        if (! isBackendAvailable (backend, frameSize))
+            continue;
+
+        std::unique_ptr<FFTEngine<T>> engine = create (backend);
+        engine->setAudioFrameSize (frameSize);
+        engine->performFFT (frame.data(), real.data(), imag.data());
+
+        // take the best of a few trials to reduce the influence of other load on the machine
+        double bestTrialTime = -1;
+
+        for (int trial = 0; trial < numTrials; trial++)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < numFramesPerTrial; i++)
+                engine->performFFT (frame.data(), real.data(), imag.data());
+
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (bestTrialTime < 0 || elapsed.count() < bestTrialTime)
+                bestTrialTime = elapsed.count();
+        }
+
+        if (fastestTime < 0 || bestTrialTime < fastestTime)
+        {
+            fastestTime = bestTrialTime;
+            fastestBackend = backend;
+        }
+    }
+
+    fastestBackends[frameSize] = fastestBackend;
+
+    return fastestBackend;
+}
+
+//===========================================================
+template class FFTEngine<float>;
+template class FFTEngine<double>;
@@ -0,0 +1,85 @@
+//=======================================================================
+/** @file FFTEngine.h
+ *  @brief The interface shared by all FFT backends, and the choice between them
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __FFTEngine__
+#define __FFTEngine__
+
+#include <memory>
+#include "FFTOptions.h"
+
+//===========================================================
+/** The interface implemented by each FFT backend. Every backend that is
+ * compiled in can be created at runtime, so one binary can choose the
+ * fastest engine available on the host it runs on.
+ *
+ * Kiss FFT and the built-in SIMD FFT are always compiled in. FFTW is
+ * compiled in with USE_FFTW and Apple Accelerate with USE_ACCELERATE_FFT */
+template <class T>
+class FFTEngine
+{
+public:
+
+    //===========================================================
+    virtual ~FFTEngine() {}
+
+    //===========================================================
+    /** Sets the audio frame size to be used in the FFT */
+    virtual void setAudioFrameSize (int frameSize) = 0;
+
+    /** Performs the FFT of a real-valued frame
+     * @param buffer the real-valued input frame
+     * @param real the real part of the non-redundant bins (frameSize / 2 + 1 values)
+     * @param imag the imaginary part of the non-redundant bins (frameSize / 2 + 1 values)
+     */
+    virtual void performFFT (const T* buffer, T* real, T* imag) = 0;
+
+    /** Sets how thoroughly the backend searches for a fast plan. Backends with
+     * no planning stage ignore this. Call it before setAudioFrameSize() to avoid planning twice */
+    virtual void setPlanningRigor (FFTPlanningRigor rigor) { (void)rigor; }
+
+    /** @Returns the backend implementing this engine */
+    virtual FFTBackend getBackend() const = 0;
+
+    //===========================================================
+    /** @Returns a new, unconfigured engine for a backend, or nullptr if the backend is not compiled in
+     * @param backend a concrete backend (not DefaultFFTBackend or AutomaticFFTBackend)
+     */
+    static std::unique_ptr<FFTEngine<T>> create (FFTBackend backend);
+
+    /** @Returns true if the backend is compiled in and can transform frames of the given size */
+    static bool isBackendAvailable (FFTBackend backend, int frameSize);
+
+    /** Resolves a requested backend to a concrete one that is available for the frame size.
+     * DefaultFFTBackend, or a backend that is not available, resolves to the default backend
+     * (Accelerate, then FFTW, then Kiss FFT if USE_KISS_FFT is defined, otherwise the SIMD FFT).
+     * AutomaticFFTBackend resolves to findFastestBackend().
+     */
+    static FFTBackend resolveBackend (FFTBackend requestedBackend, int frameSize);
+
+    /** Times every available backend on a frame of noise and returns the fastest. The
+     * result is measured once per frame size and precision, then reused for the lifetime
+     * of the process. This is safe to call from multiple threads */
+    static FFTBackend findFastestBackend (int frameSize);
+};
+
+#endif /* __FFTEngine__ */
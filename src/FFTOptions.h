@@ -0,0 +1,58 @@
+//=======================================================================
+/** @file FFTOptions.h
+ *  @brief Options controlling how Gist sets up its FFT
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __FFTOptions__
+#define __FFTOptions__
+
+//=======================================================================
+/** The FFT libraries that Gist can use */
+enum FFTBackend
+{
+    KissFFTBackend,
+    FFTWBackend,
+    AccelerateFFTBackend,
+    SimdFFTBackend,
+    DefaultFFTBackend,      /**< the preferred backend compiled in (see FFTEngine::resolveBackend()) */
+    AutomaticFFTBackend     /**< the fastest backend for the frame size, measured at runtime */
+};
+
+//=======================================================================
+/** The direction of an FFT */
+enum FFTDirection
+{
+    ForwardFFT,
+    InverseFFT
+};
+
+//=======================================================================
+/** How much effort the FFT library spends finding a fast plan for a given
+ * frame size. This maps onto FFTW_ESTIMATE, FFTW_MEASURE and FFTW_PATIENT
+ * and is ignored by FFT backends that have no planning stage */
+enum FFTPlanningRigor
+{
+    EstimatePlanning,
+    MeasurePlanning,
+    PatientPlanning
+};
+
+#endif /* __FFTOptions__ */
@@ -0,0 +1,82 @@
+//=======================================================================
+/** @file FFTPlanCache.cpp
+ *  @brief A process-wide cache of FFT plans shared between Gist instances
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#include "FFTPlanCache.h"
+
+//=======================================================================
+bool FFTPlanCache::PlanKey::operator< (const PlanKey& other) const
+{
+    if (backend != other.backend)
+        return backend < other.backend;
+    
+    if (size != other.size)
+        return size < other.size;
+    
+    if (precision != other.precision)
+        return precision < other.precision;
+    
+    if (direction != other.direction)
+        return direction < other.direction;
+    
+    return options < other.options;
+}
+
+//=======================================================================
+std::mutex& FFTPlanCache::getMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+//=======================================================================
+size_t FFTPlanCache::getNumPlans()
+{
+    std::lock_guard<std::mutex> lock (getMutex());
+    
+    size_t numPlans = 0;
+    
+    for (auto& entry : getPlans())
+    {
+        if (! entry.second.expired())
+            numPlans++;
+    }
+    
+    return numPlans;
+}
+
+//=======================================================================
+std::map<FFTPlanCache::PlanKey, std::weak_ptr<void> >& FFTPlanCache::getPlans()
+{
+    static std::map<PlanKey, std::weak_ptr<void> > plans;
+    return plans;
+}
+
+//=======================================================================
+void FFTPlanCache::removeExpiredPlan (const PlanKey& key)
+{
+    std::map<PlanKey, std::weak_ptr<void> >& plans = getPlans();
+    std::map<PlanKey, std::weak_ptr<void> >::iterator it = plans.find (key);
+    
+    if (it != plans.end() && it->second.expired())
+        plans.erase (it);
+}
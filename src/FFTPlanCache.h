@@ -0,0 +1,120 @@
+//=======================================================================
+/** @file FFTPlanCache.h
+ *  @brief A process-wide cache of FFT plans shared between Gist instances
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __FFTPlanCache__
+#define __FFTPlanCache__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include "FFTOptions.h"
+
+//=======================================================================
+/** A thread-safe, process-wide cache of immutable FFT plans (twiddle tables,
+ * FFTW plans, vDSP setups). Plans are reference counted: every FFT object
+ * with the same key shares one plan, and the plan is destroyed when the last
+ * FFT object using it releases it.
+ *
+ * All plan creation and destruction happens while holding the cache mutex,
+ * which also serialises access to planners that are not thread-safe (such as
+ * FFTW's). Code that touches such a planner outside of the cache (e.g. FFTW
+ * wisdom import/export) should lock getMutex() too.
+ */
+class FFTPlanCache
+{
+public:
+    
+    //=======================================================================
+    /** Identifies a plan in the cache */
+    struct PlanKey
+    {
+        PlanKey (FFTBackend backend_, int size_, int precision_, FFTDirection direction_, int options_ = 0)
+         :  backend (backend_), size (size_), precision (precision_), direction (direction_), options (options_)
+        {
+        }
+        
+        bool operator< (const PlanKey& other) const;
+        
+        FFTBackend backend;     /**< The FFT library the plan belongs to */
+        int size;               /**< The FFT size */
+        int precision;          /**< The size in bytes of the sample type */
+        FFTDirection direction; /**< The direction of the FFT */
+        int options;            /**< Backend-specific options that change the plan (e.g. FFTW planning rigor) */
+    };
+    
+    //=======================================================================
+    /** Returns the plan for a key, creating it if no FFT object currently holds one
+     * @param key the key identifying the plan
+     * @param createPlan a function returning a new Plan*, or nullptr on failure. Called with the cache mutex held
+     * @param destroyPlan a function destroying a Plan*. Called with the cache mutex held
+     * @returns the shared plan, or an empty pointer if the plan could not be created
+     */
+    template <class Plan, class CreateFunction, class DestroyFunction>
+    static std::shared_ptr<Plan> getPlan (const PlanKey& key, CreateFunction createPlan, DestroyFunction destroyPlan)
+    {
+        std::lock_guard<std::mutex> lock (getMutex());
+        
+        std::weak_ptr<void>& entry = getPlans()[key];
+        std::shared_ptr<void> existingPlan = entry.lock();
+        
+        if (existingPlan)
+            return std::static_pointer_cast<Plan> (existingPlan);
+        
+        Plan* plan = createPlan();
+        
+        if (plan == nullptr)
+        {
+            getPlans().erase (key);
+            return std::shared_ptr<Plan>();
+        }
+        
+        std::shared_ptr<Plan> sharedPlan (plan, [key, destroyPlan] (Plan* planToDestroy)
+        {
+            std::lock_guard<std::mutex> destroyLock (getMutex());
+            destroyPlan (planToDestroy);
+            removeExpiredPlan (key);
+        });
+        
+        entry = sharedPlan;
+        
+        return sharedPlan;
+    }
+    
+    //=======================================================================
+    /** @Returns the mutex guarding the cache and all planner calls */
+    static std::mutex& getMutex();
+    
+    /** @Returns the number of plans currently alive in the cache */
+    static size_t getNumPlans();
+    
+private:
+    
+    /** @Returns the map holding (weak references to) all plans */
+    static std::map<PlanKey, std::weak_ptr<void> >& getPlans();
+    
+    /** Removes the entry for a key if its plan has been destroyed. Must be called with the mutex held */
+    static void removeExpiredPlan (const PlanKey& key);
+};
+
+#endif /* __FFTPlanCache__ */
@@ -0,0 +1,261 @@
+//=======================================================================
+/** @file FFTWFFT.cpp
+ *  @brief Performs the FFT using FFTW
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#include "FFTWFFT.h"
+#include <assert.h>
+
+#ifdef USE_FFTW
+
+//=======================================================================
+template <class T>
+FFTWFFT<T>::FFTWFFT()
+{
+    fftSize = 0;
+    numBins = 0;
+    
+    floatIn = nullptr;
+    floatOut = nullptr;
+    
+    doubleIn = nullptr;
+    doubleOut = nullptr;
+    
+    planningRigor = EstimatePlanning;
+    configured = false;
+}
+
+//=======================================================================
+template <class T>
+FFTWFFT<T>::~FFTWFFT()
+{
+    freeFFT();
+}
+
+//=======================================================================
+template <class T>
+void FFTWFFT<T>::setPlanningRigor (FFTPlanningRigor rigor)
+{
+    planningRigor = rigor;
+    
+    if (configured)
+        setAudioFrameSize (fftSize);
+}
+
+//=======================================================================
+template <class T>
+unsigned int FFTWFFT<T>::getPlannerFlags()
+{
+    if (planningRigor == PatientPlanning)
+        return FFTW_PATIENT;
+    else if (planningRigor == MeasurePlanning)
+        return FFTW_MEASURE;
+    else
+        return FFTW_ESTIMATE;
+}
+
+//=======================================================================
+template <>
+void FFTWFFT<float>::freeFFT()
+{
+    if (configured)
+    {
+        floatPlan.reset();
+        fftwf_free (floatIn);
+        fftwf_free (floatOut);
+        configured = false;
+    }
+}
+
+//=======================================================================
+template <>
+void FFTWFFT<double>::freeFFT()
+{
+    if (configured)
+    {
+        doublePlan.reset();
+        fftw_free (doubleIn);
+        fftw_free (doubleOut);
+        configured = false;
+    }
+}
+
+//=======================================================================
+template <>
+void FFTWFFT<float>::setAudioFrameSize (int frameSize)
+{
+    freeFFT();
+    
+    fftSize = frameSize;
+    numBins = fftSize / 2 + 1;
+    
+    floatIn = (float*)fftwf_malloc (sizeof (float) * fftSize);
+    floatOut = (fftwf_complex*)fftwf_malloc (sizeof (fftwf_complex) * numBins);
+    
+    FFTPlanCache::PlanKey key (FFTWBackend, fftSize, sizeof (float), ForwardFFT, planningRigor);
+    int size = fftSize;
+    unsigned int flags = getPlannerFlags();
+    
+    floatPlan = FFTPlanCache::getPlan<fftwf_plan_s> (key, [size, flags]()
+    {
+        // plan on temporary arrays, as measuring overwrites them and each
+        // FFTWFFT object executes the shared plan on its own arrays
+        float* in = (float*)fftwf_malloc (sizeof (float) * size);
+        fftwf_complex* out = (fftwf_complex*)fftwf_malloc (sizeof (fftwf_complex) * (size / 2 + 1));
+        fftwf_plan plan = fftwf_plan_dft_r2c_1d (size, in, out, flags);
+        fftwf_free (in);
+        fftwf_free (out);
+        return plan;
+    },
+    [] (fftwf_plan plan)
+    {
+        fftwf_destroy_plan (plan);
+    });
+    
+    // couldn't set up FFT
+    assert (floatPlan != nullptr);
+    
+    configured = true;
+}
+
+//=======================================================================
+template <>
+void FFTWFFT<double>::setAudioFrameSize (int frameSize)
+{
+    freeFFT();
+    
+    fftSize = frameSize;
+    numBins = fftSize / 2 + 1;
+    
+    doubleIn = (double*)fftw_malloc (sizeof (double) * fftSize);
+    doubleOut = (fftw_complex*)fftw_malloc (sizeof (fftw_complex) * numBins);
+    
+    FFTPlanCache::PlanKey key (FFTWBackend, fftSize, sizeof (double), ForwardFFT, planningRigor);
+    int size = fftSize;
+    unsigned int flags = getPlannerFlags();
+    
+    doublePlan = FFTPlanCache::getPlan<fftw_plan_s> (key, [size, flags]()
+    {
+        // plan on temporary arrays, as measuring overwrites them and each
+        // FFTWFFT object executes the shared plan on its own arrays
+        double* in = (double*)fftw_malloc (sizeof (double) * size);
+        fftw_complex* out = (fftw_complex*)fftw_malloc (sizeof (fftw_complex) * (size / 2 + 1));
+        fftw_plan plan = fftw_plan_dft_r2c_1d (size, in, out, flags);
+        fftw_free (in);
+        fftw_free (out);
+        return plan;
+    },
+    [] (fftw_plan plan)
+    {
+        fftw_destroy_plan (plan);
+    });
+    
+    // couldn't set up FFT
+    assert (doublePlan != nullptr);
+    
+    configured = true;
+}
+
+//=======================================================================
+template <>
+void FFTWFFT<float>::performFFT (const float* buffer, float* real, float* imag)
+{
+    for (int i = 0; i < fftSize; i++)
+        floatIn[i] = buffer[i];
+    
+    fftwf_execute_dft_r2c (floatPlan.get(), floatIn, floatOut);
+    
+    for (int i = 0; i < numBins; i++)
+    {
+        real[i] = floatOut[i][0];
+        imag[i] = floatOut[i][1];
+    }
+}
+
+//=======================================================================
+template <>
+void FFTWFFT<double>::performFFT (const double* buffer, double* real, double* imag)
+{
+    for (int i = 0; i < fftSize; i++)
+        doubleIn[i] = buffer[i];
+    
+    fftw_execute_dft_r2c (doublePlan.get(), doubleIn, doubleOut);
+    
+    for (int i = 0; i < numBins; i++)
+    {
+        real[i] = doubleOut[i][0];
+        imag[i] = doubleOut[i][1];
+    }
+}
+
+//=======================================================================
+template <>
+bool FFTWFFT<float>::loadWisdom (const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock (FFTPlanCache::getMutex());
+    return fftwf_import_wisdom_from_filename (filePath.c_str()) != 0;
+}
+
+//=======================================================================
+template <>
+bool FFTWFFT<double>::loadWisdom (const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock (FFTPlanCache::getMutex());
+    return fftw_import_wisdom_from_filename (filePath.c_str()) != 0;
+}
+
+//=======================================================================
+template <>
+bool FFTWFFT<float>::saveWisdom (const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock (FFTPlanCache::getMutex());
+    return fftwf_export_wisdom_to_filename (filePath.c_str()) != 0;
+}
+
+//=======================================================================
+template <>
+bool FFTWFFT<double>::saveWisdom (const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock (FFTPlanCache::getMutex());
+    return fftw_export_wisdom_to_filename (filePath.c_str()) != 0;
+}
+
+//=======================================================================
+template <>
+void FFTWFFT<float>::forgetWisdom()
+{
+    std::lock_guard<std::mutex> lock (FFTPlanCache::getMutex());
+    fftwf_forget_wisdom();
+}
+
+//=======================================================================
+template <>
+void FFTWFFT<double>::forgetWisdom()
+{
+    std::lock_guard<std::mutex> lock (FFTPlanCache::getMutex());
+    fftw_forget_wisdom();
+}
+
+//===========================================================
+template class FFTWFFT<float>;
+template class FFTWFFT<double>;
+
+#endif
@@ -0,0 +1,116 @@
+//=======================================================================
+/** @file FFTWFFT.h
+ *  @brief Performs the FFT using FFTW
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __FFTWFFT__
+#define __FFTWFFT__
+
+#ifdef USE_FFTW
+
+#include <string>
+#include <memory>
+#include "fftw3.h"
+#include "FFTPlanCache.h"
+#include "FFTEngine.h"
+
+//===========================================================
+/** Performs the FFT using FFTW. Float instantiations use the single
+ * precision fftwf_* interface (link with -lfftw3f) and double
+ * instantiations use the double precision fftw_* interface (link with -lfftw3).
+ *
+ * Plans are created through the FFTPlanCache, so FFTWFFT objects can be set up
+ * from any thread and objects with the same size and planning rigor share one
+ * plan, each executing it on its own input and output arrays. */
+template <class T>
+class FFTWFFT : public FFTEngine<T>
+{
+public:
+
+    //===========================================================
+    FFTWFFT();
+    ~FFTWFFT();
+
+    //===========================================================
+    /** Sets the audio frame size to be used in the FFT */
+    void setAudioFrameSize (int frameSize) override;
+
+    /** Sets how thoroughly FFTW searches for a fast plan. Anything other than
+     * EstimatePlanning times candidate algorithms when the frame size is set,
+     * unless the result is already known from previously loaded wisdom.
+     * If the FFT is already configured, it is re-planned with the new setting.
+     */
+    void setPlanningRigor (FFTPlanningRigor rigor) override;
+
+    /** Performs the FFT of a real-valued frame
+     * @param buffer the real-valued input frame
+     * @param real the real part of the non-redundant bins (frameSize / 2 + 1 values)
+     * @param imag the imaginary part of the non-redundant bins (frameSize / 2 + 1 values)
+     */
+    void performFFT (const T* buffer, T* real, T* imag) override;
+
+    /** @Returns the backend implementing this engine */
+    FFTBackend getBackend() const override { return FFTWBackend; }
+
+    //===========================================================
+    /** Loads FFTW wisdom (previously measured plans) from a file into the
+     * process-wide wisdom store for the precision of T, so that measured
+     * plans can be created without repeating the measurements
+     * @param filePath the path of the wisdom file
+     * @returns true if the wisdom was loaded successfully
+     */
+    static bool loadWisdom (const std::string& filePath);
+
+    /** Saves the process-wide FFTW wisdom for the precision of T to a file
+     * @param filePath the path of the wisdom file
+     * @returns true if the wisdom was saved successfully
+     */
+    static bool saveWisdom (const std::string& filePath);
+
+    /** Clears the process-wide FFTW wisdom for the precision of T */
+    static void forgetWisdom();
+
+private:
+
+    /** @Returns the FFTW planner flags for the current planning rigor */
+    unsigned int getPlannerFlags();
+
+    /** Frees the plan and buffers, if there are any */
+    void freeFFT();
+
+    int fftSize;
+    int numBins;
+
+    std::shared_ptr<fftwf_plan_s> floatPlan;
+    float* floatIn;
+    fftwf_complex* floatOut;
+
+    std::shared_ptr<fftw_plan_s> doublePlan;
+    double* doubleIn;
+    fftw_complex* doubleOut;
+
+    FFTPlanningRigor planningRigor;
+    bool configured;
+};
+
+#endif
+
+#endif /* __FFTWFFT__ */
@@ -22,58 +22,170 @@
 //=======================================================================
 
 #include "Gist.h"
+#include "SimdKernels.h"
 #include <assert.h>
+#include <algorithm>
 
 //=======================================================================
 template <class T>
-Gist<T>::Gist (int audioFrameSize, int fs, WindowType windowType_)
- :  windowType (windowType_),
-    fftConfigured (false),
-    onsetDetectionFunction (audioFrameSize),
-    yin (fs),
-    mfcc (audioFrameSize, fs)
+Gist<T>::Gist (int audioFrameSize, int fs, WindowType windowType, FFTBackend fftBackend)
+ :  Gist (GistPlan<T>::create (typename GistPlan<T>::Settings (audioFrameSize, fs, windowType, fftBackend)))
 {
-    samplingFrequency = fs;
-    setAudioFrameSize (audioFrameSize);
+}
+
+//=======================================================================
+template <class T>
+Gist<T>::Gist (std::shared_ptr<const GistPlan<T>> plan_)
+ :  frameSize (0),
+    hopSize (plan_->getSettings().frameSize),
+    onsetDetectionFunction (plan_->getSettings().frameSize),
+    yin (plan_->getSettings().samplingFrequency),
+    mfcc (plan_->getMFCCTables())
+{
+    yin.setHopSize (hopSize);
+    setPlan (plan_);
+    buildFeaturePlan (0);
 }
 
 //=======================================================================
 template <class T>
 Gist<T>::~Gist()
 {
-    if (fftConfigured)
-    {
-        freeFFT();
-    }
 }
 
 //=======================================================================
 template <class T>
-void Gist<T>::setAudioFrameSize (int audioFrameSize)
+void Gist<T>::setPlan (std::shared_ptr<const GistPlan<T>> newPlan)
 {
-    frameSize = audioFrameSize;
+    std::shared_ptr<const GistPlan<T>> oldPlan = plan;
+    plan = newPlan;
     
-    audioFrame.resize (frameSize);
+    const typename GistPlan<T>::Settings& settings = plan->getSettings();
+    const bool frameSizeHasChanged = settings.frameSize != frameSize;
     
-    windowFunction = WindowFunctions<T>::createWindow (audioFrameSize, windowType);
+    frameSize = settings.frameSize;
+    windowFunction = plan->getWindowFunction();
+    
+    if (frameSizeHasChanged)
+    {
+        // the frame buffers and the half spectrum (real and imaginary parts apart, as every FFT backend writes them) share one aligned allocation
+        const size_t numBins = frameSize / 2 + 1;
+        
+        buffers.clear();
+        size_t audioFrameOffset = buffers.addBuffer (frameSize);
+        size_t windowedFrameOffset = buffers.addBuffer (frameSize);
+        size_t fftRealOffset = buffers.addBuffer (numBins);
+        size_t fftImagOffset = buffers.addBuffer (numBins);
+        buffers.allocate();
+        
+        audioFrame = buffers.getBuffer (audioFrameOffset);
+        windowedFrame = buffers.getBuffer (windowedFrameOffset);
+        fftReal = buffers.getBuffer (fftRealOffset);
+        fftImag = buffers.getBuffer (fftImagOffset);
+        currentFrame = audioFrame;
         
-    fftReal.resize (frameSize);
-    fftImag.resize (frameSize);
-    magnitudeSpectrum.resize (frameSize / 2);
+        // only objects that stream audio need the stream buffer, so it is laid out by the first pushToStream()
+        streamBuffer = nullptr;
+        
+        powerSpectrum.resize (frameSize / 2);
+        magnitudeSpectrum.resize (frameSize / 2);
+        
+        onsetDetectionFunction.setFrameSize (frameSize);
+    }
     
-    configureFFT();
+    configureFFT (oldPlan.get());
     
-    onsetDetectionFunction.setFrameSize (frameSize);
-    mfcc.setFrameSize (frameSize);
+    if (oldPlan != nullptr && settings.samplingFrequency != oldPlan->getSettings().samplingFrequency)
+        yin.setSamplingFrequency (settings.samplingFrequency);
+    
+    if (mfcc.getTables() != plan->getMFCCTables())
+        mfcc.setTables (plan->getMFCCTables());
+    
+    if (frameSizeHasChanged)
+        resetStream();
+    
+    invalidateFrame();
+}
+
+//=======================================================================
+template <class T>
+const std::shared_ptr<const GistPlan<T>>& Gist<T>::getPlan() const
+{
+    return plan;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::changeSettings (const typename GistPlan<T>::Settings& settings)
+{
+    setPlan (GistPlan<T>::create (settings));
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setAudioFrameSize (int audioFrameSize)
+{
+    typename GistPlan<T>::Settings settings = plan->getSettings();
+    settings.frameSize = audioFrameSize;
+    changeSettings (settings);
 }
 
 //=======================================================================
 template <class T>
 void Gist<T>::setSamplingFrequency (int fs)
 {
-    samplingFrequency = fs;
-    yin.setSamplingFrequency (samplingFrequency);
-    mfcc.setSamplingFrequency (samplingFrequency);
+    typename GistPlan<T>::Settings settings = plan->getSettings();
+    settings.samplingFrequency = fs;
+    changeSettings (settings);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setFFTPlanningRigor (FFTPlanningRigor rigor)
+{
+    typename GistPlan<T>::Settings settings = plan->getSettings();
+    settings.fftPlanningRigor = rigor;
+    changeSettings (settings);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setFFTBackend (FFTBackend backend)
+{
+    typename GistPlan<T>::Settings settings = plan->getSettings();
+    settings.fftBackend = backend;
+    changeSettings (settings);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setYinDifferenceMethod (YinDifferenceMethod method)
+{
+    yin.setDifferenceMethod (method);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setPitchFrequencyRange (T minFrequency, T maxFrequency)
+{
+    yin.setMinFrequency (minFrequency);
+    yin.setMaxFrequency (maxFrequency);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setPitchDecimationFactor (int factor)
+{
+    yin.setDecimationFactor (factor);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setHopSize (int hopSize_)
+{
+    assert (hopSize_ > 0);
+    hopSize = hopSize_;
+    yin.setHopSize (hopSize);
 }
 
 //=======================================================================
@@ -87,7 +199,21 @@ int Gist<T>::getAudioFrameSize()
 template <class T>
 int Gist<T>::getSamplingFrequency()
 {
-    return samplingFrequency;
+    return plan->getSettings().samplingFrequency;
+}
+
+//=======================================================================
+template <class T>
+FFTBackend Gist<T>::getFFTBackend()
+{
+    return fftEngine->getBackend();
+}
+
+//=======================================================================
+template <class T>
+int Gist<T>::getHopSize()
+{
+    return hopSize;
 }
 
 //=======================================================================
@@ -96,10 +222,12 @@ void Gist<T>::processAudioFrame (const std::vector<T>& a)
 {
     // you are passing an audio frame of a different size to the
     // audio frame size setup in Gist
-    assert (a.size() == audioFrame.size());
+    assert (a.size() == static_cast<size_t> (frameSize));
     
-    std::copy (a.begin(), a.end(), audioFrame.begin());
-    performFFT();
+    std::copy (a.begin(), a.end(), audioFrame);
+    currentFrame = audioFrame;
+    invalidateFrame();
+    numFramesSinceLastPitch++;
 }
 
 //=======================================================================
@@ -108,46 +236,128 @@ void Gist<T>::processAudioFrame (const T* frame, int numSamples)
 {
     // you are passing an audio frame of a different size to the
     // audio frame size setup in Gist
-    assert (static_cast<size_t> (numSamples) == audioFrame.size());
+    assert (numSamples == frameSize);
+    
+    std::copy (frame, frame + frameSize, audioFrame);
+    currentFrame = audioFrame;
+    invalidateFrame();
+    numFramesSinceLastPitch++;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::resetStream()
+{
+    if (streamBuffer != nullptr)
+        std::fill (streamBuffer, streamBuffer + frameSize * 2, (T)0);
     
-    for (size_t i = 0; i < audioFrame.size(); i++)
-        audioFrame[i] = frame[i];
+    streamWritePosition = 0;
+    numSamplesSinceLastFrame = 0;
+    streamHasFrame = false;
+    yin.resetIncrementalDifference();
+    numFramesSinceLastPitch = 0;
     
-    performFFT();
+    if (currentFrame != audioFrame)
+    {
+        currentFrame = audioFrame;
+        invalidateFrame();
+    }
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::allocateStreamBuffer()
+{
+    streamBufferMemory.clear();
+    size_t streamBufferOffset = streamBufferMemory.addBuffer (frameSize * 2);
+    streamBufferMemory.allocate();
+    
+    streamBuffer = streamBufferMemory.getBuffer (streamBufferOffset);
+}
+
+//=======================================================================
+template <class T>
+size_t Gist<T>::pushToStream (const T* samples, size_t numSamples, bool& frameIsReady)
+{
+    if (streamBuffer == nullptr)
+        allocateStreamBuffer();
+    
+    // the first frame needs a full frame of samples, the rest a hop's worth
+    int numSamplesNeeded = std::max ((streamHasFrame ? hopSize : frameSize) - numSamplesSinceLastFrame, 0);
+    size_t numSamplesToUse = std::min (numSamples, static_cast<size_t> (numSamplesNeeded));
+    
+    for (size_t i = 0; i < numSamplesToUse; i++)
+    {
+        streamBuffer[streamWritePosition] = samples[i];
+        streamBuffer[streamWritePosition + frameSize] = samples[i];
+        
+        streamWritePosition++;
+        
+        if (streamWritePosition == frameSize)
+            streamWritePosition = 0;
+    }
+    
+    numSamplesSinceLastFrame += static_cast<int> (numSamplesToUse);
+    frameIsReady = numSamplesToUse == static_cast<size_t> (numSamplesNeeded);
+    
+    if (frameIsReady)
+    {
+        // the oldest sample is at the write position, and the rest of the frame follows it contiguously
+        currentFrame = streamBuffer + streamWritePosition;
+        invalidateFrame();
+        numSamplesSinceLastFrame = 0;
+        streamHasFrame = true;
+        numFramesSinceLastPitch++;
+    }
+    
+    return numSamplesToUse;
 }
 
 //=======================================================================
 template <class T>
 const std::vector<T>& Gist<T>::getMagnitudeSpectrum()
 {
+    updateMagnitudeSpectrum();
     return magnitudeSpectrum;
 }
 
+//=======================================================================
+template <class T>
+const std::vector<T>& Gist<T>::getPowerSpectrum()
+{
+    updatePowerSpectrum();
+    return powerSpectrum;
+}
+
 //=======================================================================
 template <class T>
 T Gist<T>::rootMeanSquare()
 {
-    return coreTimeDomainFeatures.rootMeanSquare (audioFrame);
+    updateTimeDomainStatistics();
+    return timeDomainStatistics.rootMeanSquare;
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::peakEnergy()
 {
-    return coreTimeDomainFeatures.peakEnergy (audioFrame);
+    updateTimeDomainStatistics();
+    return timeDomainStatistics.peakEnergy;
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::zeroCrossingRate()
 {
-    return coreTimeDomainFeatures.zeroCrossingRate (audioFrame);
+    updateTimeDomainStatistics();
+    return timeDomainStatistics.zeroCrossingRate;
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::spectralCentroid()
 {
+    updateMagnitudeSpectrum();
     return coreFrequencyDomainFeatures.spectralCentroid (magnitudeSpectrum);
 }
 
@@ -155,13 +365,15 @@ T Gist<T>::spectralCentroid()
 template <class T>
 T Gist<T>::spectralCrest()
 {
-    return coreFrequencyDomainFeatures.spectralCrest (magnitudeSpectrum);
+    updatePowerSpectrum();
+    return coreFrequencyDomainFeatures.spectralCrestFromPowerSpectrum (powerSpectrum);
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::spectralFlatness()
 {
+    updateMagnitudeSpectrum();
     return coreFrequencyDomainFeatures.spectralFlatness (magnitudeSpectrum);
 }
 
@@ -169,6 +381,7 @@ T Gist<T>::spectralFlatness()
 template <class T>
 T Gist<T>::spectralRolloff()
 {
+    updateMagnitudeSpectrum();
     return coreFrequencyDomainFeatures.spectralRolloff (magnitudeSpectrum);
 }
 
@@ -176,6 +389,7 @@ T Gist<T>::spectralRolloff()
 template <class T>
 T Gist<T>::spectralKurtosis()
 {
+    updateMagnitudeSpectrum();
     return coreFrequencyDomainFeatures.spectralKurtosis (magnitudeSpectrum);
 }
 
@@ -183,49 +397,96 @@ T Gist<T>::spectralKurtosis()
 template <class T>
 T Gist<T>::energyDifference()
 {
-    return onsetDetectionFunction.energyDifference (audioFrame);
+    updateEnergyDifference();
+    return energyDifferenceSample;
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::spectralDifference()
 {
-    return onsetDetectionFunction.spectralDifference (magnitudeSpectrum);
+    updateOnsetDetectionSamples();
+    return onsetDetectionSamples.spectralDifference;
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::spectralDifferenceHWR()
 {
-    return onsetDetectionFunction.spectralDifferenceHWR (magnitudeSpectrum);
+    updateOnsetDetectionSamples();
+    return onsetDetectionSamples.spectralDifferenceHWR;
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::complexSpectralDifference()
 {
-    return onsetDetectionFunction.complexSpectralDifference (fftReal, fftImag);
+    updateOnsetDetectionSamples();
+    return onsetDetectionSamples.complexSpectralDifference;
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::highFrequencyContent()
 {
-    return onsetDetectionFunction.highFrequencyContent (magnitudeSpectrum);
+    updateOnsetDetectionSamples();
+    return onsetDetectionSamples.highFrequencyContent;
 }
 
 //=======================================================================
 template <class T>
 T Gist<T>::pitch()
 {
-    return yin.pitchYin (audioFrame);
+    return calculatePitch();
+}
+
+//=======================================================================
+template <class T>
+T Gist<T>::calculatePitch()
+{
+    // the incremental difference function moves its sums on by exactly one hop, so
+    // they are only kept when the frame has moved on once since the last estimate
+    if (numFramesSinceLastPitch != 1)
+        yin.resetIncrementalDifference();
+    
+    numFramesSinceLastPitch = 0;
+    
+    return yin.pitchYin (currentFrame, frameSize);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setNumMFCCs (int numCoefficients)
+{
+    typename GistPlan<T>::Settings settings = plan->getSettings();
+    settings.numMFCCs = numCoefficients;
+    changeSettings (settings);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setNumMelBands (int numBands)
+{
+    typename GistPlan<T>::Settings settings = plan->getSettings();
+    settings.numMelBands = numBands;
+    changeSettings (settings);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::setMelFrequencyRange (T minFrequency, T maxFrequency)
+{
+    typename GistPlan<T>::Settings settings = plan->getSettings();
+    settings.minMelFrequency = minFrequency;
+    settings.maxMelFrequency = maxFrequency;
+    changeSettings (settings);
 }
 
 //=======================================================================
 template <class T>
 const std::vector<T>& Gist<T>::getMelFrequencySpectrum()
 {
-    mfcc.calculateMelFrequencySpectrum (magnitudeSpectrum);
+    updateMelSpectrum();
     return mfcc.melSpectrum;
 }
 
@@ -233,132 +494,325 @@ const std::vector<T>& Gist<T>::getMelFrequencySpectrum()
 template <class T>
 const std::vector<T>& Gist<T>::getMelFrequencyCepstralCoefficients()
 {
-    mfcc.calculateMelFrequencyCepstralCoefficients (magnitudeSpectrum);
+    if (! mfccsAreValid)
+    {
+        updateMelSpectrum();
+        mfcc.calculateMelFrequencyCepstralCoefficientsFromMelSpectrum();
+        mfccsAreValid = true;
+    }
+    
     return mfcc.MFCCs;
 }
 
 //=======================================================================
 template <class T>
-void Gist<T>::configureFFT()
+void Gist<T>::computeFeatures (GistFeatureSet features, T* output)
 {
-    if (fftConfigured)
-    {
-        freeFFT();
-    }
+    if (features != featurePlan.features)
+        buildFeaturePlan (features);
+    
+    if (featurePlan.needsTimeDomainStatistics)
+        updateTimeDomainStatistics();
+    
+    const typename CoreTimeDomainFeatures<T>::Statistics& statistics = timeDomainStatistics;
     
-#ifdef USE_FFTW
-    // ------------------------------------------------------
-    // initialise the fft time and frequency domain audio frame arrays
-    fftIn = (fftw_complex*)fftw_malloc (sizeof (fftw_complex) * frameSize);  // complex array to hold fft data
-    fftOut = (fftw_complex*)fftw_malloc (sizeof (fftw_complex) * frameSize); // complex array to hold fft data
+    if (featurePlan.needsMagnitudeSpectrum)
+        updateMagnitudeSpectrum();
     
-    // FFT plan initialisation
-    p = fftw_plan_dft_1d (frameSize, fftIn, fftOut, FFTW_FORWARD, FFTW_ESTIMATE);
-#endif /* END USE_FFTW */
+    if (featurePlan.needsMelSpectrum)
+        updateMelSpectrum();
     
-#ifdef USE_KISS_FFT
-    // ------------------------------------------------------
-    // initialise the fft time and frequency domain audio frame arrays
-    fftIn = new kiss_fft_cpx[frameSize];
-    fftOut = new kiss_fft_cpx[frameSize];
-    cfg = kiss_fft_alloc (frameSize, 0, 0, 0);
-#endif /* END USE_KISS_FFT */
+    typename CoreFrequencyDomainFeatures<T>::Statistics spectralStatistics = {0, 0, 0, 0, 0};
     
-#ifdef USE_ACCELERATE_FFT
-    accelerateFFT.setAudioFrameSize (frameSize);
-#endif
+    if (featurePlan.needsSpectralStatistics)
+        spectralStatistics = coreFrequencyDomainFeatures.calculateStatistics (magnitudeSpectrum);
     
-    fftConfigured = true;
+    if (featurePlan.needsOnsetDetectionSamples)
+        updateOnsetDetectionSamples();
+    
+    if ((features & EnergyDifferenceFeature) != 0)
+        updateEnergyDifference();
+    
+    int index = 0;
+    
+    for (GistFeature feature : featurePlan.steps)
+    {
+        switch (feature)
+        {
+            case RootMeanSquareFeature: output[index++] = statistics.rootMeanSquare; break;
+            case PeakEnergyFeature: output[index++] = statistics.peakEnergy; break;
+            case ZeroCrossingRateFeature: output[index++] = statistics.zeroCrossingRate; break;
+            case SpectralCentroidFeature: output[index++] = spectralStatistics.spectralCentroid; break;
+            case SpectralCrestFeature: output[index++] = spectralStatistics.spectralCrest; break;
+            case SpectralFlatnessFeature: output[index++] = spectralStatistics.spectralFlatness; break;
+            case SpectralRolloffFeature: output[index++] = spectralStatistics.spectralRolloff; break;
+            case SpectralKurtosisFeature: output[index++] = spectralStatistics.spectralKurtosis; break;
+            case EnergyDifferenceFeature: output[index++] = energyDifferenceSample; break;
+            case SpectralDifferenceFeature: output[index++] = onsetDetectionSamples.spectralDifference; break;
+            case SpectralDifferenceHWRFeature: output[index++] = onsetDetectionSamples.spectralDifferenceHWR; break;
+            case ComplexSpectralDifferenceFeature: output[index++] = onsetDetectionSamples.complexSpectralDifference; break;
+            case HighFrequencyContentFeature: output[index++] = onsetDetectionSamples.highFrequencyContent; break;
+            case PitchFeature: output[index++] = calculatePitch(); break;
+                
+            case MelFrequencySpectrumFeature:
+                std::copy (mfcc.melSpectrum.begin(), mfcc.melSpectrum.end(), output + index);
+                index += static_cast<int> (mfcc.melSpectrum.size());
+                break;
+                
+            case MelFrequencyCepstralCoefficientsFeature:
+            {
+                const std::vector<T>& coefficients = getMelFrequencyCepstralCoefficients();
+                std::copy (coefficients.begin(), coefficients.end(), output + index);
+                index += static_cast<int> (coefficients.size());
+                break;
+            }
+        }
+    }
 }
 
 //=======================================================================
 template <class T>
-void Gist<T>::freeFFT()
+void Gist<T>::analyse (const T* signal, size_t numSamples, int hopSize, GistFeatureSet features, std::vector<T>& output)
 {
-#ifdef USE_FFTW
-    // destroy fft plan
-    fftw_destroy_plan (p);
+    assert (hopSize > 0);
+    
+    size_t numFrames = getNumAnalysisFrames (numSamples, hopSize);
+    int numValues = getNumFeatureValues (features);
+    
+    output.resize (numFrames * numValues);
+    
+    yin.setHopSize (hopSize);
+    yin.resetIncrementalDifference();
+    numFramesSinceLastPitch = 0;
     
-    fftw_free (fftIn);
-    fftw_free (fftOut);
-#endif
+    for (size_t frame = 0; frame < numFrames; frame++)
+    {
+        // analyse the frame where it sits in the signal rather than copying it
+        currentFrame = signal + frame * hopSize;
+        invalidateFrame();
+        numFramesSinceLastPitch++;
+        
+        computeFeatures (features, output.data() + frame * numValues);
+    }
     
-#ifdef USE_KISS_FFT
-    // free the Kiss FFT configuration
-    free (cfg);
+    // don't keep pointing into the caller's signal once we return
+    currentFrame = audioFrame;
+    invalidateFrame();
     
-    delete[] fftIn;
-    delete[] fftOut;
-#endif
+    yin.setHopSize (this->hopSize);
+    yin.resetIncrementalDifference();
+    numFramesSinceLastPitch = 0;
 }
 
 //=======================================================================
 template <class T>
-void Gist<T>::performFFT()
+size_t Gist<T>::getNumAnalysisFrames (size_t numSamples, int hopSize)
 {
-#ifdef USE_FFTW
-    // copy samples from audio frame
-    for (int i = 0; i < frameSize; i++)
+    if (numSamples < static_cast<size_t> (frameSize))
+        return 0;
+    
+    return 1 + (numSamples - frameSize) / hopSize;
+}
+
+//=======================================================================
+template <class T>
+int Gist<T>::getNumFeatureValues (GistFeatureSet features)
+{
+    int numValues = 0;
+    
+    for (int i = 0; i < numGistFeatures; i++)
     {
-        fftIn[i][0] = (double)(audioFrame[i] * windowFunction[i]);
-        fftIn[i][1] = (double)0.0;
+        GistFeature feature = static_cast<GistFeature> (1 << i);
+        
+        if ((features & feature) == 0)
+            continue;
+        
+        if (feature == MelFrequencySpectrumFeature)
+            numValues += static_cast<int> (mfcc.melSpectrum.size());
+        else if (feature == MelFrequencyCepstralCoefficientsFeature)
+            numValues += static_cast<int> (mfcc.MFCCs.size());
+        else
+            numValues++;
     }
     
-    // perform the FFT
-    fftw_execute (p);
+    return numValues;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::buildFeaturePlan (GistFeatureSet features)
+{
+    const GistFeatureSet timeDomainStatisticsFeatures = RootMeanSquareFeature | PeakEnergyFeature | ZeroCrossingRateFeature | EnergyDifferenceFeature;
+    const GistFeatureSet spectralStatisticsFeatures = SpectralCentroidFeature | SpectralCrestFeature | SpectralFlatnessFeature
+                                                    | SpectralRolloffFeature | SpectralKurtosisFeature;
+    const GistFeatureSet melSpectrumFeatures = MelFrequencySpectrumFeature | MelFrequencyCepstralCoefficientsFeature;
+    const GistFeatureSet magnitudeSpectrumFeatures = spectralStatisticsFeatures | SpectralDifferenceFeature | SpectralDifferenceHWRFeature
+                                                   | HighFrequencyContentFeature;
+    
+    featurePlan.features = features;
+    featurePlan.needsTimeDomainStatistics = (features & timeDomainStatisticsFeatures) != 0;
+    featurePlan.needsSpectralStatistics = (features & spectralStatisticsFeatures) != 0;
+    featurePlan.needsMagnitudeSpectrum = (features & magnitudeSpectrumFeatures) != 0;
+    featurePlan.needsMelSpectrum = (features & melSpectrumFeatures) != 0;
     
-    // store real and imaginary parts of FFT
-    for (int i = 0; i < frameSize; i++)
+    // the spectral onset detection functions always come from one pass with one history, whichever of them are asked for
+    const GistFeatureSet onsetDetectionFeatures = SpectralDifferenceFeature | SpectralDifferenceHWRFeature
+                                                | ComplexSpectralDifferenceFeature | HighFrequencyContentFeature;
+    featurePlan.needsOnsetDetectionSamples = (features & onsetDetectionFeatures) != 0;
+    
+    featurePlan.steps.clear();
+    
+    for (int i = 0; i < numGistFeatures; i++)
     {
-        fftReal[i] = (T)fftOut[i][0];
-        fftImag[i] = (T)fftOut[i][1];
+        if ((features & (1 << i)) != 0)
+            featurePlan.steps.push_back (static_cast<GistFeature> (1 << i));
     }
-#endif
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::configureFFT (const GistPlan<T>* oldPlan)
+{
+    const typename GistPlan<T>::Settings& settings = plan->getSettings();
+    const bool frameSizeHasChanged = oldPlan == nullptr || oldPlan->getSettings().frameSize != frameSize;
+    const bool rigorHasChanged = oldPlan == nullptr || oldPlan->getSettings().fftPlanningRigor != settings.fftPlanningRigor;
     
-#ifdef USE_KISS_FFT
-    for (int i = 0; i < frameSize; i++)
+    if (fftEngine == nullptr || fftEngine->getBackend() != plan->getFFTBackend())
     {
-        fftIn[i].r = (double)(audioFrame[i] * windowFunction[i]);
-        fftIn[i].i = 0.0;
+        fftEngine = FFTEngine<T>::create (plan->getFFTBackend());
+        fftEngine->setPlanningRigor (settings.fftPlanningRigor);
     }
-    
-    // execute kiss fft
-    kiss_fft (cfg, fftIn, fftOut);
-    
-    // store real and imaginary parts of FFT
-    for (int i = 0; i < frameSize; i++)
+    else
     {
-        fftReal[i] = (T)fftOut[i].r;
-        fftImag[i] = (T)fftOut[i].i;
+        // a change of rigor re-plans the engine straight away
+        if (rigorHasChanged)
+            fftEngine->setPlanningRigor (settings.fftPlanningRigor);
+        
+        if (! frameSizeHasChanged)
+            return;
     }
-#endif
     
-#ifdef USE_ACCELERATE_FFT
+    fftEngine->setAudioFrameSize (frameSize);
+    yin.setFFTEngine (fftEngine.get(), frameSize);
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::invalidateFrame()
+{
+    timeDomainStatisticsAreValid = false;
+    windowedFrameIsValid = false;
+    spectrumIsValid = false;
+    powerSpectrumIsValid = false;
+    magnitudeSpectrumIsValid = false;
+    melSpectrumIsValid = false;
+    mfccsAreValid = false;
+    onsetDetectionSamplesAreValid = false;
+    energyDifferenceIsValid = false;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::updateOnsetDetectionSamples()
+{
+    if (onsetDetectionSamplesAreValid)
+        return;
+    
+    updateMagnitudeSpectrum();
+    onsetDetectionSamples = onsetDetectionFunction.computeAll (magnitudeSpectrum, fftReal, fftImag, frameSize / 2 + 1);
     
-    T inputFrame[frameSize];
-    T outputReal[frameSize];
-    T outputImag[frameSize];
+    onsetDetectionSamplesAreValid = true;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::updateEnergyDifference()
+{
+    if (energyDifferenceIsValid)
+        return;
     
-    for (int i = 0; i < frameSize; i++)
-    {
-        inputFrame[i] = audioFrame[i] * windowFunction[i];
-    }
+    updateTimeDomainStatistics();
+    energyDifferenceSample = onsetDetectionFunction.energyDifferenceFromEnergy (timeDomainStatistics.energy);
+    
+    energyDifferenceIsValid = true;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::updateTimeDomainStatistics()
+{
+    if (timeDomainStatisticsAreValid)
+        return;
     
-    accelerateFFT.performFFT (inputFrame, outputReal, outputImag);
+    timeDomainStatistics = coreTimeDomainFeatures.calculateStatistics (currentFrame, frameSize);
     
-    for (int i = 0; i < frameSize; i++)
-    {
-        fftReal[i] = outputReal[i];
-        fftImag[i] = outputImag[i];
-    }
+    timeDomainStatisticsAreValid = true;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::updateWindowedFrame()
+{
+    if (windowedFrameIsValid)
+        return;
     
-#endif
+    SimdKernels<T>::get().multiply (currentFrame, windowFunction, windowedFrame, frameSize);
     
-    // calculate the magnitude spectrum
-    for (int i = 0; i < frameSize / 2; i++)
-    {
-        magnitudeSpectrum[i] = sqrt ((fftReal[i] * fftReal[i]) + (fftImag[i] * fftImag[i]));
-    }
+    windowedFrameIsValid = true;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::updateSpectrum()
+{
+    if (spectrumIsValid)
+        return;
+    
+    updateWindowedFrame();
+    fftEngine->performFFT (windowedFrame, fftReal, fftImag);
+    
+    spectrumIsValid = true;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::updatePowerSpectrum()
+{
+    if (powerSpectrumIsValid)
+        return;
+    
+    updateSpectrum();
+    
+    SimdKernels<T>::get().powerSpectrum (fftReal, fftImag, powerSpectrum.data(), frameSize / 2);
+    
+    powerSpectrumIsValid = true;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::updateMagnitudeSpectrum()
+{
+    if (magnitudeSpectrumIsValid)
+        return;
+    
+    updatePowerSpectrum();
+    
+    SimdKernels<T>::get().squareRoot (powerSpectrum.data(), magnitudeSpectrum.data(), frameSize / 2);
+    
+    magnitudeSpectrumIsValid = true;
+}
+
+//=======================================================================
+template <class T>
+void Gist<T>::updateMelSpectrum()
+{
+    if (melSpectrumIsValid)
+        return;
+    
+    updatePowerSpectrum();
+    mfcc.calculateMelFrequencySpectrumFromPowerSpectrum (powerSpectrum);
+    
+    melSpectrumIsValid = true;
 }
 
 //===========================================================
@@ -40,23 +40,18 @@
 
 //=======================================================================
 // fft
-#ifdef USE_FFTW
-#include "fftw3.h"
-#endif
+#include "FFTOptions.h"
+#include "FFTPlanCache.h"
+#include "FFTEngine.h"
+#include "AlignedArena.h"
+#include "GistPlan.h"
 
-#ifdef USE_KISS_FFT
-#include "kiss_fft.h"
-#endif
-
-#ifdef USE_ACCELERATE_FFT
-#include "AccelerateFFT.h"
-#endif
-
-#if !(defined(USE_FFTW) ^ defined(USE_KISS_FFT) ^ defined (USE_ACCELERATE_FFT))
-#error "You must define one FFT macro to ensure you select a FFT implementation - either USE_FFTW, USE_KISS_FFT or USE_ACCELERATE_FFT. You have either not defined one of these macros or you have defined more than one of them."
+#ifdef USE_FFTW
+#include "FFTWFFT.h"
 #endif
 
 #include "WindowFunctions.h"
+#include "GistFeatures.h"
 
 //=======================================================================
 /** Class for all performing all Gist audio analyses */
@@ -70,8 +65,17 @@ public:
      * @param audioFrameSize the input audio frame size
      * @param fs the input audio sample rate
      * @param windowType the type of window function to use
+     * @param fftBackend the FFT backend to use (see FFTEngine::resolveBackend())
+     */
+    Gist (int audioFrameSize, int fs, WindowType windowType = HanningWindow, FFTBackend fftBackend = DefaultFFTBackend);
+
+    /** Constructor, sharing a plan (the window function, FFT backend and mel filter bank) with other
+     * Gist objects. Nothing the plan holds is built again, so this is cheap, and the new object holds
+     * only the state of its own stream. Changing a setting the plan holds, e.g. with setAudioFrameSize()
+     * or setNumMFCCs(), gives this object a plan of its own and leaves the shared one untouched
+     * @param plan the plan, as returned by GistPlan::create()
      */
-    Gist (int audioFrameSize, int fs, WindowType windowType = HanningWindow);
+    Gist (std::shared_ptr<const GistPlan<T>> plan);
 
     /** Destructor */
     ~Gist();
@@ -87,15 +91,76 @@ public:
      */
     void setSamplingFrequency (int fs);
     
+    /** Set how thoroughly the FFT library searches for a fast FFT plan. This currently
+     * only has an effect when using FFTW, where it re-plans the FFT immediately. Load
+     * FFTW wisdom first (see FFTWFFT::loadWisdom()) to avoid repeating measurements.
+     * @param rigor the planning rigor to use
+     */
+    void setFFTPlanningRigor (FFTPlanningRigor rigor);
+    
+    /** Set the FFT backend. A backend that is not compiled in, or can't handle the frame size,
+     * falls back to the default one. AutomaticFFTBackend picks the fastest backend for the
+     * frame size, measuring it the first time that frame size is seen in the process.
+     * @param backend the FFT backend to use
+     */
+    void setFFTBackend (FFTBackend backend);
+    
+    /** Set how the Yin pitch detector calculates its difference function. FFTDifference uses
+     * the FFT backend in use, and is much faster than the default DirectDifference for all but
+     * the smallest frames, with results that match to within rounding error. IncrementalDifference
+     * updates the previous frame's sums instead, costing time in proportion to the hop size: it suits
+     * heavily overlapping frames from processAudioStream() or analyse(), or frames passed to
+     * processAudioFrame() exactly getHopSize() samples apart. When pitch() isn't called on every
+     * frame, the sums are calculated afresh for the next frame it is called on.
+     * @param method the difference function method to use
+     */
+    void setYinDifferenceMethod (YinDifferenceMethod method);
+    
+    /** Set the range of frequencies the pitch detector searches. Narrowing the range to the
+     * pitches expected, e.g. of speech, avoids calculating lags that can't be the period
+     * @param minFrequency the lowest frequency to search for, or 0 to search as low as the frame size allows
+     * @param maxFrequency the highest frequency to search for
+     */
+    void setPitchFrequencyRange (T minFrequency, T maxFrequency);
+    
+    /** Set the pitch detector to estimate coarse-to-fine: it finds the period of the frame decimated
+     * by the given factor, then refines it at full rate, at a fraction of the cost (see Yin::setDecimationFactor())
+     * @param factor 1 (off, the default), 2, 4 or 8
+     */
+    void setPitchDecimationFactor (int factor);
+    
+    /** Set the number of samples between the starts of successive frames produced by
+     * processAudioStream(). It defaults to the audio frame size.
+     * @param hopSize the hop size in samples
+     */
+    void setHopSize (int hopSize);
+    
+    /** Use a plan, e.g. one shared with other Gist objects, in place of the current one. Only what
+     * differs between the two plans is set up again
+     * @param plan the plan, as returned by GistPlan::create()
+     */
+    void setPlan (std::shared_ptr<const GistPlan<T>> plan);
+    
     //=======================================================================
+    /** @Returns the plan in use, which may be shared with other Gist objects */
+    const std::shared_ptr<const GistPlan<T>>& getPlan() const;
+    
     /** @Returns the audio frame size currently being used */
     int getAudioFrameSize();
     
     /** @Returns the audio sampling frequency being used for analysis */
     int getSamplingFrequency();
+    
+    /** @Returns the FFT backend currently being used */
+    FFTBackend getFFTBackend();
+    
+    /** @Returns the hop size used by processAudioStream() */
+    int getHopSize();
 
     //=======================================================================
-    /** Process an audio frame
+    /** Process an audio frame. Nothing is computed here: each representation of the frame
+     * (windowed frame, spectrum, magnitude spectrum, mel spectrum and MFCCs) is computed the
+     * first time a feature needs it, and reused by any other feature asked for on the same frame.
      * @param audioFrame a vector containing audio samples
      */
     void processAudioFrame (const std::vector<T>& audioFrame);
@@ -106,10 +171,42 @@ public:
      */
     void processAudioFrame (const T* frame, int numSamples);
 
-    /** Gist automatically calculates the magnitude spectrum when processAudioFrame() is called, this function returns it.
-     @returns the current magnitude spectrum */
+    /** Process a block of audio of any length from a continuous stream. The samples are added to
+     * an internal buffer of the last audioFrameSize samples, and callback() is called each time a
+     * new frame is complete (every hopSize samples, once the first frame has filled up). Inside the
+     * callback the new frame is the current audio frame, so features are retrieved as usual. Frames
+     * are read directly from the internal buffer, and nothing is allocated.
+     *
+     * Features should be retrieved inside the callback: later blocks overwrite the buffer.
+     * @param samples a pointer to the audio samples
+     * @param numSamples the number of samples in the block
+     * @param callback a function or lambda taking no arguments, called once per completed frame
+     */
+    template <class Callback>
+    void processAudioStream (const T* samples, size_t numSamples, Callback callback)
+    {
+        while (numSamples > 0)
+        {
+            bool frameIsReady = false;
+            size_t numSamplesUsed = pushToStream (samples, numSamples, frameIsReady);
+            
+            samples += numSamplesUsed;
+            numSamples -= numSamplesUsed;
+            
+            if (frameIsReady)
+                callback();
+        }
+    }
+    
+    /** Discards the samples buffered by processAudioStream(), so that the next frame starts afresh */
+    void resetStream();
+
+    /** @returns the magnitude spectrum of the current audio frame, calculating it if needed */
     const std::vector<T>& getMagnitudeSpectrum();
 
+    /** @returns the power spectrum (squared magnitude spectrum) of the current audio frame, calculating it if needed */
+    const std::vector<T>& getPowerSpectrum();
+
     //================= CORE TIME DOMAIN FEATURES =================
 
     /** @Returns the root mean square (RMS) of the currently stored audio frame */
@@ -140,6 +237,9 @@ public:
 
     //================= ONSET DETECTION FUNCTIONS =================
 
+    // Each onset detection function moves its history on once per frame, so asking for
+    // it again before the next frame returns the same value
+
     /** @Returns the energy difference onset detection function sample for the magnitude spectrum frame */
     T energyDifference();
 
@@ -162,53 +262,174 @@ public:
 
     //=========================== MFCCs =============================
     
+    /** Set the number of Mel-frequency cepstral coefficients to calculate. Until setNumMelBands()
+     * is called, this is also the number of bands in the mel spectrum. The default is 13
+     * @param numCoefficients the number of coefficients
+     */
+    void setNumMFCCs (int numCoefficients);
+    
+    /** Set the number of bands in the mel spectrum independently of the number of coefficients,
+     * e.g. 40 bands for 13 coefficients
+     * @param numBands the number of mel bands
+     */
+    void setNumMelBands (int numBands);
+    
+    /** Set the range of frequencies covered by the mel spectrum and MFCCs
+     * @param minFrequency the lowest frequency in Hz
+     * @param maxFrequency the highest frequency in Hz, or 0 for half the sampling frequency (the default)
+     */
+    void setMelFrequencyRange (T minFrequency, T maxFrequency);
+    
     /** Calculates the Mel Frequency Spectrum */
     const std::vector<T>& getMelFrequencySpectrum();
 
     /** Calculates the Mel-frequency Cepstral Coefficients */
     const std::vector<T>& getMelFrequencyCepstralCoefficients();
     
+    //======================== FEATURE SETS =========================
+    
+    /** Calculates several features of the current audio frame in one call. The steps a feature
+     * set needs are worked out the first time it is used and reused while the same set is
+     * requested, so stages no feature needs are skipped, intermediate results are shared and
+     * the core time domain features (and the energy difference) come from one pass over the frame.
+     * Onset detection functions are calculated once per frame, so they update their history
+     * exactly as the individual functions do and return the same values.
+     * @param features a combination of GistFeature flags, e.g. RootMeanSquareFeature | PitchFeature
+     * @param output an array of at least getNumFeatureValues (features) values, filled in the order of the GistFeature enum
+     */
+    void computeFeatures (GistFeatureSet features, T* output);
+    
+    /** @Returns the number of values computeFeatures() writes for a feature set */
+    int getNumFeatureValues (GistFeatureSet features);
+    
+    //======================== OFFLINE ANALYSIS =====================
+    
+    /** Calculates a feature set for every frame of a whole signal. Frames start every hopSize
+     * samples and are analysed in place in the signal, so no samples are copied. Only complete
+     * frames are analysed. Onset detection functions and pitch tracking carry their history from
+     * one frame to the next, as if each frame had been passed to processAudioFrame() in turn.
+     * Afterwards the individual feature functions refer to the last frame passed to
+     * processAudioFrame() again.
+     * @param signal a pointer to the audio samples
+     * @param numSamples the number of samples in the signal
+     * @param hopSize the number of samples between the starts of successive frames
+     * @param features a combination of GistFeature flags
+     * @param output resized to getNumAnalysisFrames() rows of getNumFeatureValues (features) values, one row per frame
+     */
+    void analyse (const T* signal, size_t numSamples, int hopSize, GistFeatureSet features, std::vector<T>& output);
+    
+    /** @Returns the number of frames analyse() produces for a signal of numSamples samples */
+    size_t getNumAnalysisFrames (size_t numSamples, int hopSize);
+    
 private:
     //=======================================================================
 
-    /** Configure the FFT implementation given the audio frame size) */
-    void configureFFT();
+    /** Gives this object a plan of its own for a change of settings */
+    void changeSettings (const typename GistPlan<T>::Settings& settings);
+
+    /** Configure the FFT implementation for the plan, given the plan used before it
+     * @param oldPlan the previous plan, or nullptr if there was none
+     */
+    void configureFFT (const GistPlan<T>* oldPlan);
+
+    /** Adds samples to the stream buffer, stopping early when a frame is completed
+     * @param samples a pointer to the audio samples
+     * @param numSamples the number of samples available
+     * @param frameIsReady set to true if a frame was completed, which then becomes the current frame
+     * @returns the number of samples used
+     */
+    size_t pushToStream (const T* samples, size_t numSamples, bool& frameIsReady);
+
+    /** Lays out the stream buffer for the current frame size, filled with zeros */
+    void allocateStreamBuffer();
 
-    /** Free all FFT-related data */
-    void freeFFT();
+    /** Estimates the pitch of the current frame, first discarding the incremental Yin difference function
+     * sums unless the frame has moved on exactly once since the last estimate */
+    T calculatePitch();
 
-    /** perform the FFT on the current audio frame */
-    void performFFT();
+    /** Marks everything derived from the audio frame as out of date */
+    void invalidateFrame();
+
+    /** Applies the window function to the current audio frame, unless already done for this frame */
+    void updateWindowedFrame();
+
+    /** Calculates the energy, RMS, peak energy and zero crossing rate in one pass, unless already done for this frame */
+    void updateTimeDomainStatistics();
+
+    /** Performs the FFT on the windowed frame, unless already done for this frame */
+    void updateSpectrum();
+
+    /** Calculates the power spectrum, unless already done for this frame */
+    void updatePowerSpectrum();
+
+    /** Calculates the magnitude spectrum from the power spectrum, unless already done for this frame */
+    void updateMagnitudeSpectrum();
+
+    /** Calculates the mel spectrum, unless already done for this frame */
+    void updateMelSpectrum();
+
+    /** Calculates the four spectral onset detection functions in one pass with one history, unless already done for this frame */
+    void updateOnsetDetectionSamples();
+
+    /** Calculates the energy difference, unless already done for this frame */
+    void updateEnergyDifference();
+
+    /** Works out the steps computeFeatures() takes for a feature set */
+    void buildFeaturePlan (GistFeatureSet features);
 
     //=======================================================================
+    /** The steps computeFeatures() takes for one feature set */
+    struct FeaturePlan
+    {
+        GistFeatureSet features;            /**< The feature set the plan was built for */
+        bool needsTimeDomainStatistics;     /**< True if the single pass over the audio frame is needed */
+        bool needsSpectralStatistics;       /**< True if the fused spectral statistics are needed */
+        bool needsMagnitudeSpectrum;        /**< True if the magnitude spectrum is needed */
+        bool needsMelSpectrum;              /**< True if the mel spectrum is needed */
+        bool needsOnsetDetectionSamples;    /**< True if any spectral onset detection function is needed */
+        std::vector<GistFeature> steps;     /**< The requested features, in output order */
+    };
 
-#ifdef USE_FFTW
-    fftw_plan p;          /**< fftw plan */
-    fftw_complex* fftIn;  /**< to hold complex fft values for input */
-    fftw_complex* fftOut; /**< to hold complex fft values for output */
-#endif
+    //=======================================================================
 
-#ifdef USE_KISS_FFT
-    kiss_fft_cfg cfg;     /**< Kiss FFT configuration */
-    kiss_fft_cpx* fftIn;  /**< FFT input samples, in complex form */
-    kiss_fft_cpx* fftOut; /**< FFT output samples, in complex form */
-#endif
-    
-#ifdef USE_ACCELERATE_FFT
-    AccelerateFFT<T> accelerateFFT;
-#endif
+    std::shared_ptr<const GistPlan<T>> plan; /**< The settings, window function and tables, possibly shared with other Gist objects */
+    std::unique_ptr<FFTEngine<T>> fftEngine; /**< The FFT backend in use */
 
     int frameSize;                    /**< The audio frame size */
-    int samplingFrequency;            /**< The sampling frequency used for analysis */
-    WindowType windowType;            /**< The window type used in FFT analysis */
 
-    std::vector<T> audioFrame;        /**< The current audio frame */
-    std::vector<T> windowFunction;    /**< The window function used in FFT processing */
-    std::vector<T> fftReal;           /**< The real part of the FFT for the current audio frame */
-    std::vector<T> fftImag;           /**< The imaginary part of the FFT for the current audio frame */
+    AlignedArena<T> buffers;          /**< The memory holding audioFrame, windowedFrame, fftReal and fftImag */
+    AlignedArena<T> streamBufferMemory; /**< The memory holding streamBuffer, once audio has been streamed */
+    T* audioFrame;                    /**< The last audio frame passed to processAudioFrame() */
+    const T* currentFrame;            /**< The frame being analysed: audioFrame, or a frame inside the signal passed to analyse() or the stream buffer */
+    
+    int hopSize;                      /**< The number of samples between frames produced by processAudioStream() */
+    T* streamBuffer;                  /**< The last frameSize streamed samples, stored twice in a row so that every frame is contiguous, or nullptr until audio is streamed */
+    int streamWritePosition;          /**< Where the next streamed sample is written (and its copy frameSize samples later) */
+    int numSamplesSinceLastFrame;     /**< The number of samples streamed since the last frame was completed */
+    bool streamHasFrame;              /**< True once the stream has filled its first frame */
+    int numFramesSinceLastPitch;      /**< The number of new frames since the last pitch estimate, which the incremental Yin difference function needs to be exactly one */
+    const T* windowFunction;          /**< The window function used in FFT processing, held by the plan */
+    T* windowedFrame;                 /**< The current audio frame multiplied by the window function */
+    T* fftReal;                       /**< The real part of the FFT for the current audio frame (bins 0 to frameSize / 2) */
+    T* fftImag;                       /**< The imaginary part of the FFT for the current audio frame (bins 0 to frameSize / 2) */
+    std::vector<T> powerSpectrum;     /**< The power spectrum (squared magnitude spectrum) of the current audio frame */
     std::vector<T> magnitudeSpectrum; /**< The magnitude spectrum of the current audio frame */
 
-    bool fftConfigured;
+    typename CoreTimeDomainFeatures<T>::Statistics timeDomainStatistics; /**< The time domain statistics of the current audio frame */
+    typename OnsetDetectionFunction<T>::Samples onsetDetectionSamples;   /**< The spectral onset detection functions of the current audio frame */
+    T energyDifferenceSample;         /**< The energy difference of the current audio frame */
+
+    bool timeDomainStatisticsAreValid; /**< True if timeDomainStatistics is up to date with audioFrame */
+    bool windowedFrameIsValid;        /**< True if windowedFrame is up to date with audioFrame */
+    bool spectrumIsValid;             /**< True if fftReal and fftImag are up to date with audioFrame */
+    bool powerSpectrumIsValid;        /**< True if powerSpectrum is up to date with audioFrame */
+    bool magnitudeSpectrumIsValid;    /**< True if magnitudeSpectrum is up to date with audioFrame */
+    bool melSpectrumIsValid;          /**< True if the mel spectrum is up to date with audioFrame */
+    bool mfccsAreValid;               /**< True if the MFCCs are up to date with audioFrame */
+    bool onsetDetectionSamplesAreValid; /**< True if onsetDetectionSamples is up to date with audioFrame */
+    bool energyDifferenceIsValid;     /**< True if energyDifferenceSample is up to date with audioFrame */
+
+    FeaturePlan featurePlan;          /**< The plan for the feature set last passed to computeFeatures() */
 
     /** object to compute core time domain features */
     CoreTimeDomainFeatures<T> coreTimeDomainFeatures;
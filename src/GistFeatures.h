@@ -0,0 +1,68 @@
+//=======================================================================
+/** @file GistFeatures.h
+ *  @brief Flags naming the features that Gist can compute in one call
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __GistFeatures__
+#define __GistFeatures__
+
+#include <stdint.h>
+
+//=======================================================================
+/** Flags naming the features that Gist::computeFeatures() can calculate. Combine
+ * them with | to form a GistFeatureSet. Features are written to the output in the
+ * order they are listed here */
+enum GistFeature
+{
+    // core time domain features
+    RootMeanSquareFeature               = 1 << 0,
+    PeakEnergyFeature                   = 1 << 1,
+    ZeroCrossingRateFeature             = 1 << 2,
+
+    // core frequency domain features
+    SpectralCentroidFeature             = 1 << 3,
+    SpectralCrestFeature                = 1 << 4,
+    SpectralFlatnessFeature             = 1 << 5,
+    SpectralRolloffFeature              = 1 << 6,
+    SpectralKurtosisFeature             = 1 << 7,
+
+    // onset detection functions
+    EnergyDifferenceFeature             = 1 << 8,
+    SpectralDifferenceFeature           = 1 << 9,
+    SpectralDifferenceHWRFeature        = 1 << 10,
+    ComplexSpectralDifferenceFeature    = 1 << 11,
+    HighFrequencyContentFeature         = 1 << 12,
+
+    // pitch
+    PitchFeature                        = 1 << 13,
+
+    // vector features, each writing one value per coefficient
+    MelFrequencySpectrumFeature         = 1 << 14,
+    MelFrequencyCepstralCoefficientsFeature = 1 << 15
+};
+
+/** A combination of GistFeature flags */
+typedef uint32_t GistFeatureSet;
+
+/** The number of GistFeature flags */
+const int numGistFeatures = 16;
+
+#endif /* __GistFeatures__ */
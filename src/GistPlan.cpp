@@ -0,0 +1,55 @@
+//=======================================================================
+/** @file GistPlan.cpp
+ *  @brief The immutable part of a Gist analysis, shared between streams
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#include "GistPlan.h"
+#include "FFTEngine.h"
+#include <algorithm>
+
+//=======================================================================
+template <class T>
+GistPlan<T>::GistPlan (const Settings& settings_)
+ :  settings (settings_)
+{
+    fftBackend = FFTEngine<T>::resolveBackend (settings.fftBackend, settings.frameSize);
+
+    size_t windowFunctionOffset = buffers.addBuffer (settings.frameSize);
+    buffers.allocate();
+
+    std::vector<T> window = WindowFunctions<T>::createWindow (settings.frameSize, settings.windowType);
+    std::copy (window.begin(), window.end(), buffers.getBuffer (windowFunctionOffset));
+    windowFunction = buffers.getBuffer (windowFunctionOffset);
+
+    mfccTables = MFCC<T>::createTables (settings.frameSize, settings.samplingFrequency, settings.numMFCCs,
+                                        settings.numMelBands, settings.minMelFrequency, settings.maxMelFrequency);
+}
+
+//=======================================================================
+template <class T>
+std::shared_ptr<const GistPlan<T>> GistPlan<T>::create (const Settings& settings)
+{
+    return std::make_shared<const GistPlan<T>> (settings);
+}
+
+//===========================================================
+template class GistPlan<float>;
+template class GistPlan<double>;
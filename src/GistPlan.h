@@ -0,0 +1,122 @@
+//=======================================================================
+/** @file GistPlan.h
+ *  @brief The immutable part of a Gist analysis, shared between streams
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __GistPlan__
+#define __GistPlan__
+
+#include <memory>
+#include "FFTOptions.h"
+#include "WindowFunctions.h"
+#include "AlignedArena.h"
+#include "MFCC.h"
+
+//=======================================================================
+/** Everything about a Gist analysis that depends only on its settings: the window function,
+ * the FFT backend chosen for the frame size and the mel filter bank and discrete cosine
+ * transform tables. A plan never changes once built, so it is safe to share between any
+ * number of Gist objects on any number of threads.
+ *
+ * To analyse many streams with the same settings, build one plan and construct a Gist for
+ * each stream from it. Each Gist then holds only the state of its own stream (its frame and
+ * spectrum buffers, and the onset detection function and pitch tracking histories), and is
+ * cheap to create:
+ *
+ *     std::shared_ptr<const GistPlan<float>> plan = GistPlan<float>::create (GistPlan<float>::Settings (512, 8000));
+ *     Gist<float> stream (plan);
+ *
+ * The FFT twiddle tables themselves are shared through the FFTPlanCache as before.
+ *
+ * Instantiations of the class should be of either 'float' or 'double' types and no others
+ */
+template <class T>
+class GistPlan
+{
+public:
+
+    //=======================================================================
+    /** The settings a plan is built for */
+    struct Settings
+    {
+        /** Constructor, with the defaults for everything but the frame size and sampling frequency */
+        Settings (int frameSize_, int samplingFrequency_, WindowType windowType_ = HanningWindow, FFTBackend fftBackend_ = DefaultFFTBackend)
+         :  frameSize (frameSize_),
+            samplingFrequency (samplingFrequency_),
+            windowType (windowType_),
+            fftBackend (fftBackend_),
+            fftPlanningRigor (EstimatePlanning),
+            numMFCCs (13),
+            numMelBands (0),
+            minMelFrequency (0),
+            maxMelFrequency (0)
+        {
+        }
+
+        int frameSize;                      /**< The audio frame size */
+        int samplingFrequency;              /**< The sampling frequency in Hz */
+        WindowType windowType;              /**< The window function used in FFT analysis */
+        FFTBackend fftBackend;              /**< The FFT backend asked for (see FFTEngine::resolveBackend()) */
+        FFTPlanningRigor fftPlanningRigor;  /**< How thoroughly the FFT backend searches for a fast plan */
+        int numMFCCs;                       /**< The number of Mel-frequency cepstral coefficients */
+        int numMelBands;                    /**< The number of bands in the mel spectrum, or 0 for the same as numMFCCs */
+        T minMelFrequency;                  /**< The lowest frequency in Hz covered by the mel spectrum */
+        T maxMelFrequency;                  /**< The highest frequency in Hz covered by the mel spectrum, or 0 for half the sampling frequency */
+    };
+
+    //=======================================================================
+    /** Constructor
+     * @param settings the settings to build the plan for
+     */
+    explicit GistPlan (const Settings& settings);
+
+    /** @returns a new plan, ready to share between Gist objects
+     * @param settings the settings to build the plan for
+     */
+    static std::shared_ptr<const GistPlan<T>> create (const Settings& settings);
+
+    //=======================================================================
+    /** @returns the settings the plan was built for */
+    const Settings& getSettings() const { return settings; }
+
+    /** @returns the FFT backend the requested one resolved to for the frame size */
+    FFTBackend getFFTBackend() const { return fftBackend; }
+
+    /** @returns the window function, of getSettings().frameSize values */
+    const T* getWindowFunction() const { return windowFunction; }
+
+    /** @returns the mel filter bank and discrete cosine transform tables */
+    const std::shared_ptr<const typename MFCC<T>::Tables>& getMFCCTables() const { return mfccTables; }
+
+private:
+
+    GistPlan (const GistPlan&) = delete;
+    GistPlan& operator= (const GistPlan&) = delete;
+
+    //=======================================================================
+    Settings settings;                                              /**< The settings the plan was built for */
+    FFTBackend fftBackend;                                          /**< The FFT backend resolved for the frame size */
+    AlignedArena<T> buffers;                                        /**< The memory holding the window function */
+    const T* windowFunction;                                        /**< The window function */
+    std::shared_ptr<const typename MFCC<T>::Tables> mfccTables;     /**< The mel filter bank and discrete cosine transform tables */
+};
+
+#endif /* __GistPlan__ */
@@ -0,0 +1,128 @@
+//=======================================================================
+/** @file KissFFT.cpp
+ *  @brief Performs the FFT using Kiss FFT
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#define _USE_MATH_DEFINES
+#include "KissFFT.h"
+#include <cmath>
+
+//=======================================================================
+template <class T>
+KissFFT<T>::KissFFT()
+ :  fftSize (0),
+    complexFFTSize (0)
+{
+}
+
+//=======================================================================
+template <class T>
+void KissFFT<T>::setAudioFrameSize (int frameSize)
+{
+    fftSize = frameSize;
+
+    // for even frame sizes, the real input is packed into a complex FFT of half
+    // the size, and the spectrum is unpacked afterwards using the plan's twiddles
+    complexFFTSize = (fftSize % 2 == 0) ? fftSize / 2 : fftSize;
+
+    FFTPlanCache::PlanKey key (KissFFTBackend, fftSize, sizeof (T), ForwardFFT);
+    int numFFTSamples = fftSize;
+    int numComplexFFTSamples = complexFFTSize;
+
+    plan = FFTPlanCache::getPlan<Plan> (key, [numFFTSamples, numComplexFFTSamples]()
+    {
+        Plan* newPlan = new Plan (numComplexFFTSamples);
+
+        if (numComplexFFTSamples != numFFTSamples)
+        {
+            newPlan->realFFTTwiddles.resize (numComplexFFTSamples);
+
+            for (int i = 0; i < numComplexFFTSamples; i++)
+            {
+                double phase = -2. * M_PI * ((double)i) / ((double)numFFTSamples);
+                newPlan->realFFTTwiddles[i] = Complex ((T)cos (phase), (T)sin (phase));
+            }
+        }
+
+        return newPlan;
+    },
+    [] (Plan* planToDestroy)
+    {
+        delete planToDestroy;
+    });
+
+    fftIn.resize (complexFFTSize);
+    fftOut.resize (complexFFTSize);
+}
+
+//=======================================================================
+template <class T>
+void KissFFT<T>::performFFT (const T* buffer, T* real, T* imag)
+{
+    if (complexFFTSize == fftSize)
+    {
+        // odd frame sizes use a full complex FFT with zero imaginary parts
+        for (int i = 0; i < fftSize; i++)
+            fftIn[i] = Complex (buffer[i], 0);
+
+        plan->fft.transform (fftIn.data(), fftOut.data());
+
+        for (int i = 0; i <= fftSize / 2; i++)
+        {
+            real[i] = fftOut[i].real();
+            imag[i] = fftOut[i].imag();
+        }
+    }
+    else
+    {
+        // pack even samples into the real part and odd samples into the imaginary part
+        for (int i = 0; i < complexFFTSize; i++)
+            fftIn[i] = Complex (buffer[2 * i], buffer[2 * i + 1]);
+
+        plan->fft.transform (fftIn.data(), fftOut.data());
+
+        // the DC and Nyquist bins are purely real
+        real[0] = fftOut[0].real() + fftOut[0].imag();
+        imag[0] = 0;
+        real[complexFFTSize] = fftOut[0].real() - fftOut[0].imag();
+        imag[complexFFTSize] = 0;
+
+        // separate the spectra of the even and odd samples and combine them
+        for (int i = 1; i < complexFFTSize; i++)
+        {
+            const Complex& a = fftOut[i];
+            const Complex& b = fftOut[complexFFTSize - i];
+            const Complex& w = plan->realFFTTwiddles[i];
+
+            T evenReal = (T)0.5 * (a.real() + b.real());
+            T evenImag = (T)0.5 * (a.imag() - b.imag());
+            T oddReal = (T)0.5 * (a.imag() + b.imag());
+            T oddImag = (T)-0.5 * (a.real() - b.real());
+
+            real[i] = evenReal + (w.real() * oddReal - w.imag() * oddImag);
+            imag[i] = evenImag + (w.real() * oddImag + w.imag() * oddReal);
+        }
+    }
+}
+
+//===========================================================
+template class KissFFT<float>;
+template class KissFFT<double>;
@@ -0,0 +1,82 @@
+//=======================================================================
+/** @file KissFFT.h
+ *  @brief Performs the FFT using Kiss FFT
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __KissFFT__
+#define __KissFFT__
+
+#include <complex>
+#include <vector>
+#include <memory>
+#include "kissfft.hh"
+#include "FFTPlanCache.h"
+#include "FFTEngine.h"
+
+//===========================================================
+/** Performs the FFT using Kiss FFT. The templated version of Kiss FFT
+ * is used so that the transform runs natively in the precision of T. The
+ * twiddle tables are shared between all KissFFT objects of the same size
+ * through the FFTPlanCache */
+template <class T>
+class KissFFT : public FFTEngine<T>
+{
+public:
+
+    //===========================================================
+    KissFFT();
+
+    //===========================================================
+    /** Sets the audio frame size to be used in the FFT */
+    void setAudioFrameSize (int frameSize) override;
+
+    /** Performs the FFT of a real-valued frame
+     * @param buffer the real-valued input frame
+     * @param real the real part of the non-redundant bins (frameSize / 2 + 1 values)
+     * @param imag the imaginary part of the non-redundant bins (frameSize / 2 + 1 values)
+     */
+    void performFFT (const T* buffer, T* real, T* imag) override;
+
+    /** @Returns the backend implementing this engine */
+    FFTBackend getBackend() const override { return KissFFTBackend; }
+
+private:
+
+    typedef std::complex<T> Complex;
+
+    /** The immutable part of the FFT for one frame size */
+    struct Plan
+    {
+        Plan (int complexFFTSize) : fft (complexFFTSize, false) {}
+
+        kissfft<T> fft;                       /**< the complex FFT (only its twiddles and factors are used, it has no other state) */
+        std::vector<Complex> realFFTTwiddles; /**< twiddles used to unpack the half size complex FFT */
+    };
+
+    int fftSize;
+    int complexFFTSize;
+
+    std::shared_ptr<Plan> plan;
+    std::vector<Complex> fftIn;
+    std::vector<Complex> fftOut;
+};
+
+#endif /* __KissFFT__ */
@@ -22,42 +22,114 @@
 //=======================================================================
 
 #include "MFCC.h"
+#include "SimdKernels.h"
 #include <cfloat>
 #include <assert.h>
+#include <algorithm>
 
 //==================================================================
 template <class T>
 MFCC<T>::MFCC (int frameSize_, int samplingFrequency_)
 {
-    numCoefficents = 13;
-    frameSize = frameSize_;
-    samplingFrequency = samplingFrequency_;
+    setTables (createTables (frameSize_, samplingFrequency_));
+}
 
-    initialise();
+//==================================================================
+template <class T>
+MFCC<T>::MFCC (std::shared_ptr<const Tables> tables_)
+{
+    setTables (tables_);
 }
 
 //==================================================================
 template <class T>
 void MFCC<T>::setNumCoefficients (int numCoefficients_)
 {
-    numCoefficents = numCoefficients_;
-    initialise();
+    setTables (createTables (tables->frameSize, tables->samplingFrequency, numCoefficients_,
+                             tables->numMelBandsIsIndependent ? tables->numMelBands : 0, tables->minFrequency, tables->maxFrequency));
+}
+
+//==================================================================
+template <class T>
+void MFCC<T>::setNumMelBands (int numMelBands_)
+{
+    setTables (createTables (tables->frameSize, tables->samplingFrequency, tables->numCoefficients,
+                             numMelBands_, tables->minFrequency, tables->maxFrequency));
+}
+
+//==================================================================
+template <class T>
+void MFCC<T>::setFrequencyRange (T minFrequency_, T maxFrequency_)
+{
+    setTables (createTables (tables->frameSize, tables->samplingFrequency, tables->numCoefficients,
+                             tables->numMelBandsIsIndependent ? tables->numMelBands : 0, minFrequency_, maxFrequency_));
 }
 
 //==================================================================
 template <class T>
 void MFCC<T>::setFrameSize (int frameSize_)
 {
-    frameSize = frameSize_;
-    initialise();
+    setTables (createTables (frameSize_, tables->samplingFrequency, tables->numCoefficients,
+                             tables->numMelBandsIsIndependent ? tables->numMelBands : 0, tables->minFrequency, tables->maxFrequency));
 }
 
 //==================================================================
 template <class T>
 void MFCC<T>::setSamplingFrequency (int samplingFrequency_)
 {
-    samplingFrequency = samplingFrequency_;
-    initialise();
+    setTables (createTables (tables->frameSize, samplingFrequency_, tables->numCoefficients,
+                             tables->numMelBandsIsIndependent ? tables->numMelBands : 0, tables->minFrequency, tables->maxFrequency));
+}
+
+//==================================================================
+template <class T>
+void MFCC<T>::setTables (std::shared_ptr<const Tables> tables_)
+{
+    tables = tables_;
+    
+    melSpectrum.resize (tables->numMelBands);
+    MFCCs.resize (std::min (tables->numCoefficients, tables->numMelBands));
+    dctSignal.resize (tables->numMelBands);
+    
+    // the FFT for the fast discrete cosine transform is created the first time it is needed
+    if (tables->useFFTForDCT)
+    {
+        size_t numInputs = dctSignal.size();
+        
+        dctFFTInput.resize (numInputs);
+        dctFFTReal.resize (numInputs / 2 + 1);
+        dctFFTImag.resize (numInputs / 2 + 1);
+    }
+    
+    dctFFT.reset();
+}
+
+//==================================================================
+template <class T>
+std::shared_ptr<const typename MFCC<T>::Tables> MFCC<T>::createTables (int frameSize, int samplingFrequency, int numCoefficients,
+                                                                       int numMelBands, T minFrequency, T maxFrequency)
+{
+    std::shared_ptr<Tables> tables (new Tables());
+    tables->frameSize = frameSize;
+    tables->samplingFrequency = samplingFrequency;
+    tables->numCoefficients = numCoefficients;
+    tables->numMelBands = numMelBands > 0 ? numMelBands : numCoefficients;
+    tables->numMelBandsIsIndependent = numMelBands > 0;
+    tables->minFrequency = minFrequency;
+    tables->maxFrequency = maxFrequency;
+    
+    buildTables (*tables);
+    return tables;
+}
+
+//==================================================================
+template <class T>
+void MFCC<T>::buildTables (Tables& tables)
+{
+    tables.magnitudeSpectrumSize = tables.frameSize / 2;
+    
+    calculateMelFilterBank (tables);
+    initialiseDiscreteCosineTransform (tables);
 }
 
 //==================================================================
@@ -65,23 +137,34 @@ template <class T>
 void MFCC<T>::calculateMelFrequencyCepstralCoefficients (const std::vector<T>& magnitudeSpectrum)
 {
     calculateMelFrequencySpectrum (magnitudeSpectrum);
-    
+    calculateMelFrequencyCepstralCoefficientsFromMelSpectrum();
+}
+
+//==================================================================
+template <class T>
+void MFCC<T>::calculateMelFrequencyCepstralCoefficientsFromMelSpectrum()
+{
     for (size_t i = 0; i < melSpectrum.size(); i++)
-        MFCCs[i] = log (melSpectrum[i] + (T)FLT_MIN);
+        dctSignal[i] = log (melSpectrum[i] + (T)FLT_MIN);
 
-    discreteCosineTransform (MFCCs, MFCCs.size());
+    discreteCosineTransform (dctSignal.data(), dctSignal.size(), MFCCs.data(), MFCCs.size());
 }
 
 //==================================================================
 template <class T>
 void MFCC<T>::calculateMelFrequencySpectrum (const std::vector<T>& magnitudeSpectrum)
 {
-    for (int i = 0; i < numCoefficents; i++)
+    for (int i = 0; i < tables->numMelBands; i++)
     {
         double coeff = 0;
         
-        for (size_t j = 0; j < magnitudeSpectrum.size(); j++)
-            coeff += (T)((magnitudeSpectrum[j] * magnitudeSpectrum[j]) * filterBank[i][j]);
+        // only the bins a filter covers contribute to its band
+        const FilterSpan& span = tables->filterSpans[i];
+        const T* spectrum = magnitudeSpectrum.data() + span.startBin;
+        const T* weights = tables->filterWeights.data() + span.weightsOffset;
+        
+        for (int j = 0; j < span.numBins; j++)
+            coeff += (T)((spectrum[j] * spectrum[j]) * weights[j]);
         
         melSpectrum[i] = coeff;
     }
@@ -89,83 +172,166 @@ void MFCC<T>::calculateMelFrequencySpectrum (const std::vector<T>& magnitudeSpec
 
 //==================================================================
 template <class T>
-void MFCC<T>::initialise()
+void MFCC<T>::calculateMelFrequencySpectrumFromPowerSpectrum (const std::vector<T>& powerSpectrum)
 {
-    magnitudeSpectrumSize = frameSize / 2;
-    minFrequency = 0;
-    maxFrequency = samplingFrequency / 2;
-
-    melSpectrum.resize (numCoefficents);
-    MFCCs.resize (numCoefficents);
-    dctSignal.resize (numCoefficents);
+    const SimdKernels<T>& kernels = SimdKernels<T>::get();
     
-    calculateMelFilterBank();
+    for (int i = 0; i < tables->numMelBands; i++)
+    {
+        const FilterSpan& span = tables->filterSpans[i];
+        const T* spectrum = powerSpectrum.data() + span.startBin;
+        const T* weights = tables->filterWeights.data() + span.weightsOffset;
+        
+        melSpectrum[i] = kernels.dotProduct (spectrum, weights, (size_t)span.numBins);
+    }
 }
 
 //==================================================================
 template <class T>
-void MFCC<T>::discreteCosineTransform (std::vector<T>& inputSignal, const std::size_t numElements)
+void MFCC<T>::initialiseDiscreteCosineTransform (Tables& tables)
 {
-    // the input signal must have the number of elements specified in the numElements variable
-    assert (inputSignal.size() == numElements);
+    size_t numInputs = tables.numMelBands;
+    size_t numOutputs = std::min (tables.numCoefficients, tables.numMelBands);
     
-    // this should already be the case - sanity check
-    assert (dctSignal.size() == numElements);
-        
-    for (size_t i = 0; i < numElements; i++)
-        dctSignal[i] = inputSignal[i];
+    // the basis costs numOutputs x numInputs multiply-adds, and the FFT roughly
+    // numInputs log2 (numInputs) plus its overheads, which pay off from about here
+    const size_t minBasisSizeForFFT = 2048;
     
-    T N = (T)numElements;
-    T piOverN = M_PI / N;
-
-    for (size_t k = 0; k < numElements; k++)
+    tables.useFFTForDCT = numOutputs * numInputs >= minBasisSizeForFFT;
+    
+    if (tables.useFFTForDCT)
     {
-        T sum = 0;
-        T kVal = (T)k;
-
-        for (size_t n = 0; n < numElements; n++)
+        tables.dctTwiddlesReal.resize (numOutputs);
+        tables.dctTwiddlesImag.resize (numOutputs);
+        
+        for (size_t k = 0; k < numOutputs; k++)
         {
-            T tmp = piOverN * (((T)n) + 0.5) * kVal;
-            sum += dctSignal[n] * cos (tmp);
+            double angle = M_PI * k / (2.0 * numInputs);
+            tables.dctTwiddlesReal[k] = (T)(2.0 * cos (angle));
+            tables.dctTwiddlesImag[k] = (T)(2.0 * sin (angle));
+        }
+    }
+    else
+    {
+        T N = (T)numInputs;
+        T piOverN = M_PI / N;
+        
+        tables.dctBasis.resize (numOutputs * numInputs);
+        
+        for (size_t k = 0; k < numOutputs; k++)
+        {
+            T kVal = (T)k;
+            
+            for (size_t n = 0; n < numInputs; n++)
+            {
+                T tmp = piOverN * (((T)n) + 0.5) * kVal;
+                tables.dctBasis[k * numInputs + n] = cos (tmp);
+            }
         }
-
-        inputSignal[k] = (T)(2 * sum);
     }
 }
 
 //==================================================================
 template <class T>
-void MFCC<T>::calculateMelFilterBank()
+void MFCC<T>::discreteCosineTransform (const T* inputSignal, const std::size_t numInputs, T* outputSignal, const std::size_t numOutputs)
 {
-    int maxMel = floor (frequencyToMel (maxFrequency));
-    int minMel = floor (frequencyToMel (minFrequency));
-
-    filterBank.resize (numCoefficents);
+    // the transform has been set up for this many inputs and outputs
+    assert (numInputs == dctSignal.size());
+    assert (numOutputs == MFCCs.size());
+    
+    if (tables->useFFTForDCT)
+    {
+        fastDiscreteCosineTransform (inputSignal, numInputs, outputSignal, numOutputs);
+        return;
+    }
+    
+    const SimdKernels<T>& kernels = SimdKernels<T>::get();
 
-    for (int i = 0; i < numCoefficents; i++)
+    // only the rows for the values asked for are evaluated
+    for (size_t k = 0; k < numOutputs; k++)
     {
-        filterBank[i].resize (magnitudeSpectrumSize);
+        const T* basis = tables->dctBasis.data() + k * numInputs;
+        outputSignal[k] = (T)(2 * kernels.dotProduct (inputSignal, basis, numInputs));
+    }
+}
 
-        for (int j = 0; j < magnitudeSpectrumSize; j++)
-            filterBank[i][j] = 0.0;
+//==================================================================
+template <class T>
+void MFCC<T>::fastDiscreteCosineTransform (const T* inputSignal, const std::size_t numInputs, T* outputSignal, const std::size_t numOutputs)
+{
+    size_t N = numInputs;
+    
+    // v = the even samples in order, then the odd samples in reverse
+    for (size_t n = 0; 2 * n < N; n++)
+        dctFFTInput[n] = inputSignal[2 * n];
+    
+    for (size_t n = 0; 2 * n + 1 < N; n++)
+        dctFFTInput[N - 1 - n] = inputSignal[2 * n + 1];
+    
+    if (dctFFT == nullptr)
+    {
+        dctFFT = FFTEngine<T>::create (FFTEngine<T>::resolveBackend (DefaultFFTBackend, (int)N));
+        dctFFT->setAudioFrameSize ((int)N);
     }
+    
+    dctFFT->performFFT (dctFFTInput.data(), dctFFTReal.data(), dctFFTImag.data());
+    
+    // X[k] = 2 Re (exp (-i pi k / 2N) V[k]), with V[k] = conj (V[N - k]) above N / 2
+    for (size_t k = 0; k < numOutputs; k++)
+    {
+        T real, imag;
+        
+        if (k <= N / 2)
+        {
+            real = dctFFTReal[k];
+            imag = dctFFTImag[k];
+        }
+        else
+        {
+            real = dctFFTReal[N - k];
+            imag = -dctFFTImag[N - k];
+        }
+        
+        outputSignal[k] = tables->dctTwiddlesReal[k] * real + tables->dctTwiddlesImag[k] * imag;
+    }
+}
+
+//==================================================================
+template <class T>
+void MFCC<T>::calculateMelFilterBank (Tables& tables)
+{
+    const int numMelBands = tables.numMelBands;
+    const int samplingFrequency = tables.samplingFrequency;
+    
+    T nyquist = (T)(samplingFrequency / 2);
+    T filterBankMaxFrequency = (tables.maxFrequency > 0) ? std::min (tables.maxFrequency, nyquist) : nyquist;
+    T filterBankMinFrequency = std::min (std::max (tables.minFrequency, (T)0), filterBankMaxFrequency);
+
+    int maxMel = floor (frequencyToMel (filterBankMaxFrequency));
+    int minMel = floor (frequencyToMel (filterBankMinFrequency));
 
     std::vector<int> centreIndices;
 
-    for (int i = 0; i < numCoefficents + 2; i++)
+    for (int i = 0; i < numMelBands + 2; i++)
     {
-        double f = i * (maxMel - minMel) / (numCoefficents + 1) + minMel;
+        double f = i * (maxMel - minMel) / (numMelBands + 1) + minMel;
 
         double tmp = log (1 + 1000.0 / 700.0) / 1000.0;
         tmp = (exp (f * tmp) - 1) / (samplingFrequency / 2);
-        tmp = 0.5 + 700 * ((double)magnitudeSpectrumSize) * tmp;
+        tmp = 0.5 + 700 * ((double)tables.magnitudeSpectrumSize) * tmp;
         tmp = floor (tmp);
 
         int centreIndex = (int)tmp;
         centreIndices.push_back (centreIndex);
     }
 
-    for (int i = 0; i < numCoefficents; i++)
+    std::vector<FilterSpan>& filterSpans = tables.filterSpans;
+    std::vector<T>& filterWeights = tables.filterWeights;
+    
+    filterSpans.resize (numMelBands);
+    filterWeights.clear();
+
+    for (int i = 0; i < numMelBands; i++)
     {
         int filterBeginIndex = centreIndices[i];
         int filterCenterIndex = centreIndices[i + 1];
@@ -174,13 +340,17 @@ void MFCC<T>::calculateMelFilterBank()
         T triangleRangeUp = (T)(filterCenterIndex - filterBeginIndex);
         T triangleRangeDown = (T)(filterEndIndex - filterCenterIndex);
 
+        filterSpans[i].startBin = filterBeginIndex;
+        filterSpans[i].numBins = filterEndIndex - filterBeginIndex;
+        filterSpans[i].weightsOffset = (int)filterWeights.size();
+
         // upward slope
         for (int k = filterBeginIndex; k < filterCenterIndex; k++)
-            filterBank[i][k] = ((T)(k - filterBeginIndex)) / triangleRangeUp;
+            filterWeights.push_back (((T)(k - filterBeginIndex)) / triangleRangeUp);
 
         // downwards slope
         for (int k = filterCenterIndex; k < filterEndIndex; k++)
-            filterBank[i][k] = ((T)(filterEndIndex - k)) / triangleRangeDown;
+            filterWeights.push_back (((T)(filterEndIndex - k)) / triangleRangeDown);
     }
 }
 
@@ -27,7 +27,9 @@
 #define _USE_MATH_DEFINES
 #include <vector>
 #include <cmath>
+#include <memory>
 #include <stddef.h>
+#include "FFTEngine.h"
 
 //=======================================================================
 /** Template class for calculating Mel Frequency Cepstral Coefficients
@@ -38,16 +40,77 @@ class MFCC
 {
 public:
     
+    //=======================================================================
+    /** the bins covered by one triangular filter */
+    struct FilterSpan
+    {
+        int startBin;         /**< the first magnitude spectrum bin the filter covers */
+        int numBins;          /**< the number of bins the filter covers */
+        int weightsOffset;    /**< the index of the filter's first weight in filterWeights */
+    };
+
+    /** The settings of the calculation, and the mel filter bank and discrete cosine transform
+     * tables built for them. They never change once built, so any number of MFCC objects with the
+     * same settings can share one set (see GistPlan), from any number of threads */
+    struct Tables
+    {
+        int frameSize;                          /**< the audio frame size */
+        int samplingFrequency;                  /**< the sampling frequency in Hz */
+        int numCoefficients;                    /**< the number of MFCCs to calculate */
+        int numMelBands;                        /**< the number of mel bands in the mel spectrum */
+        bool numMelBandsIsIndependent;          /**< true if the number of mel bands was set independently of the number of coefficients */
+        T minFrequency;                         /**< the minimum frequency to be used in the calculation of MFCCs */
+        T maxFrequency;                         /**< the maximum frequency to be used in the calculation of MFCCs, or 0 for half the sampling frequency */
+        int magnitudeSpectrumSize;              /**< the magnitude spectrum size (this will be half the frame size) */
+        
+        std::vector<FilterSpan> filterSpans;    /**< the bins each triangular filter covers */
+        std::vector<T> filterWeights;           /**< the weights of all the triangular filters, one filter after another */
+        
+        bool useFFTForDCT;                      /**< true if the discrete cosine transform is calculated with the FFT, which is faster for large numbers of bands */
+        std::vector<T> dctBasis;                /**< the discrete cosine transform basis, one row of numMelBands cosines for each output value */
+        std::vector<T> dctTwiddlesReal;         /**< 2 cos (pi k / 2N) for each output value k */
+        std::vector<T> dctTwiddlesImag;         /**< 2 sin (pi k / 2N) for each output value k */
+    };
+
+    /** Builds the tables for a set of settings
+     * @param frameSize the audio frame size
+     * @param samplingFrequency the sampling frequency in Hz
+     * @param numCoefficients the number of coefficients to calculate
+     * @param numMelBands the number of mel bands, or 0 for the same as the number of coefficients
+     * @param minFrequency the lowest frequency in Hz covered by the mel filter bank
+     * @param maxFrequency the highest frequency in Hz covered by the mel filter bank, or 0 for half the sampling frequency
+     */
+    static std::shared_ptr<const Tables> createTables (int frameSize, int samplingFrequency, int numCoefficients = 13,
+                                                       int numMelBands = 0, T minFrequency = 0, T maxFrequency = 0);
+
     //=======================================================================
     /** Constructor */
     MFCC (int frameSize_, int samplingFrequency_);
 
+    /** Constructor, sharing tables that have already been built
+     * @param tables the tables, as returned by createTables()
+     */
+    MFCC (std::shared_ptr<const Tables> tables);
+
     //=======================================================================
-    /** Set the number of coefficients to calculate
+    /** Set the number of coefficients to calculate. Until setNumMelBands() is called, this also sets
+     * the number of mel bands. No more coefficients are calculated than there are mel bands
      * @param numCoefficients_ the number of coefficients to calculate 
      */
     void setNumCoefficients (int numCoefficients_);
 
+    /** Set the number of mel bands (triangular filters) in the mel spectrum, independently of the
+     * number of coefficients, e.g. 40 bands for 13 coefficients. Only the coefficients asked for are calculated
+     * @param numMelBands_ the number of mel bands
+     */
+    void setNumMelBands (int numMelBands_);
+
+    /** Set the range of frequencies covered by the mel filter bank. The default is 0 Hz to half the sampling frequency
+     * @param minFrequency_ the lowest frequency in Hz
+     * @param maxFrequency_ the highest frequency in Hz, or 0 for half the sampling frequency
+     */
+    void setFrequencyRange (T minFrequency_, T maxFrequency_);
+
     /** Set the frame size - N.B. this will be twice the length of the magnitude spectrum passed to calculateMFCC()
      * @param frameSize_ the frame size
      */
@@ -58,6 +121,15 @@ public:
      */
     void setSamplingFrequency (int samplingFrequency_);
 
+    /** Use tables that have already been built, in place of the current ones. Each of the
+     * setters above builds new tables of this object's own, leaving any shared ones untouched
+     * @param tables the tables, as returned by createTables()
+     */
+    void setTables (std::shared_ptr<const Tables> tables);
+
+    /** @returns the tables in use */
+    const std::shared_ptr<const Tables>& getTables() const { return tables; }
+
     //=======================================================================
     /** Calculates the Mel Frequency Cepstral Coefficients from the magnitude spectrum of a signal. The result
      * is stored in the public vector MFCCs.
@@ -73,6 +145,18 @@ public:
      */
     void calculateMelFrequencySpectrum (const std::vector<T>& magnitudeSpectrum);
 
+    /** Calculates the magnitude spectrum on a Mel scale from the power spectrum (the squared
+     * magnitude spectrum), saving the square root and squaring of each bin when the power spectrum
+     * is at hand. The result is stored in the public vector melSpectrum.
+     */
+    void calculateMelFrequencySpectrumFromPowerSpectrum (const std::vector<T>& powerSpectrum);
+
+    /** Calculates the Mel Frequency Cepstral Coefficients from the mel spectrum already held in
+     * the public vector melSpectrum, so that it isn't computed twice when both are needed. The
+     * result is stored in the public vector MFCCs.
+     */
+    void calculateMelFrequencyCepstralCoefficientsFromMelSpectrum();
+
     //=======================================================================
     /** a vector to hold the mel spectrum once it has been computed */
     std::vector<T> melSpectrum;
@@ -81,52 +165,57 @@ public:
     std::vector<T> MFCCs;
     
 private:
-    /** Initialises the parts of the algorithm dependent on frame size, sampling frequency
-     * and the number of coefficients
+    /** Calculates the first numOutputs values of the discrete cosine transform (version 2) of an input
+     * signal. This uses the basis precomputed by initialiseDiscreteCosineTransform(), or the FFT when
+     * that is faster (see Tables::useFFTForDCT)
+     *
+     * @param inputSignal the input signal
+     * @param numInputs the number of elements in the input signal
+     * @param outputSignal the array to write the result to
+     * @param numOutputs the number of values to calculate, at most numInputs
      */
-    void initialise();
+    void discreteCosineTransform (const T* inputSignal, const std::size_t numInputs, T* outputSignal, const std::size_t numOutputs);
 
-    /** Calculates the discrete cosine transform (version 2) of an input signal, performing it in place
-     * (i.e. the result is stored in the vector passed to the function)
+    /** Calculates the first numOutputs values of the discrete cosine transform (version 2) with
+     * Makhoul's algorithm: a real FFT of the input reordered as its even samples followed by its
+     * odd samples in reverse, rotated by the precomputed twiddles.
      *
-     * @param inputSignal a vector containing the input signal
-     * @param numElements the number of elements in the input signal
+     * @param inputSignal the input signal
+     * @param numInputs the number of elements in the input signal
+     * @param outputSignal the array to write the result to
+     * @param numOutputs the number of values to calculate, at most numInputs
      */
-    void discreteCosineTransform (std::vector<T>& inputSignal, const std::size_t numElements);
+    void fastDiscreteCosineTransform (const T* inputSignal, const std::size_t numInputs, T* outputSignal, const std::size_t numOutputs);
+
+    /** Builds the filter bank and discrete cosine transform tables for the settings already in a Tables */
+    static void buildTables (Tables& tables);
+
+    /** Precomputes whatever the discrete cosine transform needs for the number of
+     * coefficients and mel bands: either its basis, or the twiddles for the FFT */
+    static void initialiseDiscreteCosineTransform (Tables& tables);
 
     /** Calculates the triangular filters used in the algorithm. These will be different depending
      * upon the frame size, sampling frequency and number of coefficients and so should be re-calculated
      * should any of those parameters change.
      */
-    void calculateMelFilterBank();
+    static void calculateMelFilterBank (Tables& tables);
 
     /** Calculates mel from frequency
      * @param frequency the frequency in Hz
      * @returns the equivalent mel value
      */
-    T frequencyToMel (T frequency);
+    static T frequencyToMel (T frequency);
 
-    /** the sampling frequency in Hz */
-    int samplingFrequency;
+    /** the filter bank and discrete cosine transform tables, possibly shared with other MFCC objects */
+    std::shared_ptr<const Tables> tables;
 
-    /** the number of MFCCs to calculate */
-    int numCoefficents;
-
-    /** the audio frame size */
-    int frameSize;
-
-    /** the magnitude spectrum size (this will be half the frame size) */
-    int magnitudeSpectrumSize;
-
-    /** the minimum frequency to be used in the calculation of MFCCs */
-    T minFrequency;
-
-    /** the maximum frequency to be used in the calculation of MFCCs */
-    T maxFrequency;
-
-    /** a vector of vectors to hold the values of the triangular filters */
-    std::vector<std::vector<T> > filterBank;
+    /** the log mel spectrum, the input to the discrete cosine transform */
     std::vector<T> dctSignal;
+
+    std::unique_ptr<FFTEngine<T>> dctFFT;   /**< the FFT used by the fast discrete cosine transform, created when first used */
+    std::vector<T> dctFFTInput;             /**< the reordered input to the fast discrete cosine transform */
+    std::vector<T> dctFFTReal;              /**< the real part of the FFT of dctFFTInput */
+    std::vector<T> dctFFTImag;              /**< the imaginary part of the FFT of dctFFTInput */
 };
 
 #endif /* defined(__GIST__MFCC__) */
@@ -22,6 +22,8 @@
 //=======================================================================
 
 #include "OnsetDetectionFunction.h"
+#include "SimdKernels.h"
+#include <algorithm>
 
 //===========================================================
 template <class T>
@@ -33,24 +35,16 @@ OnsetDetectionFunction<T>::OnsetDetectionFunction (int frameSize)
 
 //===========================================================
 template <class T>
-void OnsetDetectionFunction<T>::setFrameSize (int frameSize)
+void OnsetDetectionFunction<T>::setFrameSize (int frameSize_)
 {
-    // resize the prev magnitude spectrum vector
-    prevMagnitudeSpectrum_spectralDifference.resize (frameSize);
-    prevMagnitudeSpectrum_spectralDifferenceHWR.resize (frameSize);
-    prevPhaseSpectrum_complexSpectralDifference.resize (frameSize);
-    prevPhaseSpectrum2_complexSpectralDifference.resize (frameSize);
-    prevMagnitudeSpectrum_complexSpectralDifference.resize (frameSize);
-
-    // fill it with zeros
-    for (size_t i = 0; i < prevMagnitudeSpectrum_spectralDifference.size(); i++)
-    {
-        prevMagnitudeSpectrum_spectralDifference[i] = 0.0;
-        prevMagnitudeSpectrum_spectralDifferenceHWR[i] = 0.0;
-        prevPhaseSpectrum_complexSpectralDifference[i] = 0.0;
-        prevPhaseSpectrum2_complexSpectralDifference[i] = 0.0;
-        prevMagnitudeSpectrum_complexSpectralDifference[i] = 0.0;
-    }
+    frameSize = frameSize_;
+    
+    // the histories are sized to the spectra passed in when they are first used,
+    // so clearing them here resets them to zeros for the new frame size
+    prevMagnitudeSpectrum_spectralDifference.clear();
+    prevMagnitudeSpectrum_spectralDifferenceHWR.clear();
+    clearSpectralHistory (history_complexSpectralDifference);
+    clearSpectralHistory (sharedHistory);
 
     prevEnergySum = 0;
 }
@@ -61,19 +55,32 @@ void OnsetDetectionFunction<T>::setFrameSize (int frameSize)
 //===========================================================
 template <class T>
 T OnsetDetectionFunction<T>::energyDifference (const std::vector<T>& buffer)
+{
+    return energyDifference (buffer.data(), buffer.size());
+}
+
+//===========================================================
+template <class T>
+T OnsetDetectionFunction<T>::energyDifference (const T* buffer, size_t numSamples)
 {
     T sum;
-    T difference;
 
     sum = 0; // initialise sum
 
     // sum the squares of the samples
-    for (size_t i = 0; i < buffer.size(); i++)
+    for (size_t i = 0; i < numSamples; i++)
         sum = sum + (buffer[i] * buffer[i]);
 
-    difference = sum - prevEnergySum; // sample is first order difference in energy
+    return energyDifferenceFromEnergy (sum);
+}
 
-    prevEnergySum = sum; // store energy value for next calculation
+//===========================================================
+template <class T>
+T OnsetDetectionFunction<T>::energyDifferenceFromEnergy (T energy)
+{
+    T difference = energy - prevEnergySum; // sample is first order difference in energy
+
+    prevEnergySum = energy; // store energy value for next calculation
 
     if (difference > 0)
         return difference;
@@ -87,6 +94,8 @@ T OnsetDetectionFunction<T>::spectralDifference (const std::vector<T>& magnitude
 {
     T sum = 0; // initialise sum to zero
 
+    prepareHistory (prevMagnitudeSpectrum_spectralDifference, magnitudeSpectrum.size());
+
     for (size_t i = 0; i < magnitudeSpectrum.size(); i++)
     {
         // calculate difference
@@ -114,6 +123,8 @@ T OnsetDetectionFunction<T>::spectralDifferenceHWR (const std::vector<T>& magnit
 {
     T sum = 0; // initialise sum to zero
 
+    prepareHistory (prevMagnitudeSpectrum_spectralDifferenceHWR, magnitudeSpectrum.size());
+
     for (size_t i = 0; i < magnitudeSpectrum.size(); i++)
     {
         // calculate difference
@@ -137,49 +148,21 @@ T OnsetDetectionFunction<T>::spectralDifferenceHWR (const std::vector<T>& magnit
 template <class T>
 T OnsetDetectionFunction<T>::complexSpectralDifference (const std::vector<T>& fftReal, const std::vector<T>& fftImag)
 {
-    T dev, pdev;
-    T sum;
-    T magDiff, phaseDiff;
-    T value;
-    T phaseVal;
-    T magVal;
-
-    sum = 0; // initialise sum to zero
-
-    // compute phase values from fft output and sum deviations
-    for (size_t i = 0; i < fftReal.size(); i++)
-    {
-        // calculate phase value
-        phaseVal = atan2 (fftImag[i], fftReal[i]);
-
-        // calculate magnitude value
-        magVal = sqrt ((fftReal[i] * fftReal[i]) + (fftImag[i] * fftImag[i]));
-
-        // phase deviation
-        dev = phaseVal - (2 * prevPhaseSpectrum_complexSpectralDifference[i]) + prevPhaseSpectrum2_complexSpectralDifference[i];
-
-        // wrap into [-pi,pi] range
-        pdev = princarg (dev);
-
-        // calculate magnitude difference (real part of Euclidean distance between complex frames)
-        magDiff = magVal - prevMagnitudeSpectrum_complexSpectralDifference[i];
-
-        // calculate phase difference (imaginary part of Euclidean distance between complex frames)
-        phaseDiff = -magVal * sin (pdev);
-
-        // square real and imaginary parts, sum and take square root
-        value = sqrt ((magDiff * magDiff) + (phaseDiff * phaseDiff));
-
-        // add to sum
-        sum = sum + value;
-
-        // store values for next calculation
-        prevPhaseSpectrum2_complexSpectralDifference[i] = prevPhaseSpectrum_complexSpectralDifference[i];
-        prevPhaseSpectrum_complexSpectralDifference[i] = phaseVal;
-        prevMagnitudeSpectrum_complexSpectralDifference[i] = magVal;
-    }
+    return complexSpectralDifference (fftReal.data(), fftImag.data(), fftReal.size());
+}
 
-    return sum;
+//===========================================================
+template <class T>
+T OnsetDetectionFunction<T>::complexSpectralDifference (const T* fftReal, const T* fftImag, size_t numBins)
+{
+    SpectralHistory& history = history_complexSpectralDifference;
+    
+    prepareSpectralHistory (history, numBins);
+    
+    T sums[4] = {0, 0, 0, 0};
+    addSpectralDifferences (nullptr, fftReal, fftImag, getHistoryPointers (history), 0, numBins, numBins, sums);
+    
+    return sums[2];
 }
 
 //===========================================================
@@ -196,17 +179,131 @@ T OnsetDetectionFunction<T>::highFrequencyContent (const std::vector<T>& magnitu
 
 //===========================================================
 template <class T>
-T OnsetDetectionFunction<T>::princarg (T phaseVal)
+typename OnsetDetectionFunction<T>::Samples OnsetDetectionFunction<T>::computeAll (const std::vector<T>& magnitudeSpectrum, const std::vector<T>& fftReal, const std::vector<T>& fftImag)
 {
-    // if phase value is less than or equal to -pi then add 2*pi
-    while (phaseVal <= (-M_PI))
-        phaseVal = phaseVal + (2 * M_PI);
+    return computeAll (magnitudeSpectrum, fftReal.data(), fftImag.data(), fftReal.size());
+}
 
-    // if phase value is larger than pi, then subtract 2*pi
-    while (phaseVal > M_PI)
-        phaseVal = phaseVal - (2 * M_PI);
+//===========================================================
+template <class T>
+typename OnsetDetectionFunction<T>::Samples OnsetDetectionFunction<T>::computeAll (const std::vector<T>& magnitudeSpectrum, const T* fftReal, const T* fftImag, size_t numComplexBins)
+{
+    const size_t numMagnitudeBins = magnitudeSpectrum.size();
+    const size_t numSharedBins = numMagnitudeBins < numComplexBins ? numMagnitudeBins : numComplexBins;
+    const size_t numBins = numMagnitudeBins > numComplexBins ? numMagnitudeBins : numComplexBins;
+    
+    prepareSpectralHistory (sharedHistory, numBins);
+    
+    const SpectralHistoryPointers<T> history = getHistoryPointers (sharedHistory);
+    T* prevMagnitude = history.magnitude;
+    
+    T sums[4] = {0, 0, 0, 0};
+    addSpectralDifferences (magnitudeSpectrum.data(), fftReal, fftImag, history, 0, numSharedBins, numComplexBins, sums);
+    
+    Samples samples = {sums[0], sums[1], sums[2], sums[3]};
+    
+    // bins only the complex spectrum covers (such as the Nyquist bin) count towards the complex spectral difference alone
+    if (numComplexBins > numSharedBins)
+    {
+        T complexBinSums[4] = {0, 0, 0, 0};
+        addSpectralDifferences (nullptr, fftReal, fftImag, history, numSharedBins, numComplexBins, numComplexBins, complexBinSums);
+        
+        samples.complexSpectralDifference += complexBinSums[2];
+    }
+    
+    // and bins only the magnitude spectrum covers count towards the others
+    for (size_t i = numSharedBins; i < numMagnitudeBins; i++)
+    {
+        T diff = magnitudeSpectrum[i] - prevMagnitude[i];
+        
+        samples.spectralDifference += diff < 0 ? -diff : diff;
+        samples.spectralDifferenceHWR += diff > 0 ? diff : 0;
+        samples.highFrequencyContent += magnitudeSpectrum[i] * ((T)(i + 1));
+        
+        prevMagnitude[i] = magnitudeSpectrum[i];
+    }
+    
+    return samples;
+}
 
-    return phaseVal;
+//===========================================================
+template <class T>
+void OnsetDetectionFunction<T>::addSpectralDifferences (const T* magnitudeSpectrum, const T* fftReal, const T* fftImag,
+                                                        const SpectralHistoryPointers<T>& history, size_t begin, size_t end,
+                                                        size_t numComplexBins, T* sums)
+{
+    // a half spectrum leaves out the mirror images of bins 1 to (frameSize - 1) / 2. Those are
+    // the complex conjugates of the bins kept, with the same distance from their predictions,
+    // so counting the kept bins twice gives the complex spectral difference of the full spectrum
+    size_t mirroredBegin = 1;
+    size_t mirroredEnd = 1;
+    
+    if (frameSize > 2 && numComplexBins == static_cast<size_t> (frameSize / 2 + 1))
+        mirroredEnd = static_cast<size_t> ((frameSize + 1) / 2);
+    
+    mirroredBegin = std::min (std::max (mirroredBegin, begin), end);
+    mirroredEnd = std::min (std::max (mirroredEnd, mirroredBegin), end);
+    
+    const size_t boundaries[4] = {begin, mirroredBegin, mirroredEnd, end};
+    const SimdKernels<T>& kernels = SimdKernels<T>::get();
+    
+    for (int i = 0; i < 3; i++)
+    {
+        if (boundaries[i] == boundaries[i + 1])
+            continue;
+        
+        T rangeSums[4] = {0, 0, 0, 0};
+        kernels.spectralDifferences (magnitudeSpectrum, fftReal, fftImag, history, boundaries[i], boundaries[i + 1], rangeSums);
+        
+        sums[0] += rangeSums[0];
+        sums[1] += rangeSums[1];
+        sums[2] += i == 1 ? 2 * rangeSums[2] : rangeSums[2];
+        sums[3] += rangeSums[3];
+    }
+}
+
+//===========================================================
+template <class T>
+void OnsetDetectionFunction<T>::prepareHistory (std::vector<T>& history, size_t numBins, T initialValue)
+{
+    if (history.size() != numBins)
+        history.assign (numBins, initialValue);
+}
+
+//===========================================================
+template <class T>
+void OnsetDetectionFunction<T>::prepareSpectralHistory (SpectralHistory& history, size_t numBins)
+{
+    // a phase of zero is the phasor 1 + 0j
+    prepareHistory (history.magnitude, numBins);
+    prepareHistory (history.phasorReal, numBins, 1);
+    prepareHistory (history.phasorImag, numBins);
+    prepareHistory (history.phasor2Real, numBins, 1);
+    prepareHistory (history.phasor2Imag, numBins);
+}
+
+//===========================================================
+template <class T>
+SpectralHistoryPointers<T> OnsetDetectionFunction<T>::getHistoryPointers (SpectralHistory& history)
+{
+    SpectralHistoryPointers<T> pointers;
+    pointers.magnitude = history.magnitude.data();
+    pointers.phasorReal = history.phasorReal.data();
+    pointers.phasorImag = history.phasorImag.data();
+    pointers.phasor2Real = history.phasor2Real.data();
+    pointers.phasor2Imag = history.phasor2Imag.data();
+    return pointers;
+}
+
+//===========================================================
+template <class T>
+void OnsetDetectionFunction<T>::clearSpectralHistory (SpectralHistory& history)
+{
+    history.magnitude.clear();
+    history.phasorReal.clear();
+    history.phasorImag.clear();
+    history.phasor2Real.clear();
+    history.phasor2Imag.clear();
 }
 
 //===========================================================
@@ -27,6 +27,8 @@
 #define _USE_MATH_DEFINES
 #include <vector>
 #include <cmath>
+#include <stddef.h>
+#include "SimdKernels.h"
 
 /** template class for calculating onset detection functions
  * Instantiations of the class should be of either 'float' or 
@@ -40,8 +42,9 @@ public:
     OnsetDetectionFunction (int frameSize);
 
     //===========================================================
-    /** Sets the frame size of internal buffers. Assumes all magnitude
-     * spectra are passed as the first half (i.e. not mirrored)
+    /** Sets the frame size and clears the spectral histories. Each history is
+     * sized to the spectra passed in the first time it is used, so passing
+     * the first half of each spectrum (i.e. not mirrored) keeps it at half size
      * @param frameSize the frame size
      */
     void setFrameSize (int frameSize);
@@ -53,6 +56,19 @@ public:
      */
     T energyDifference (const std::vector<T>& buffer);
 
+    /** calculates the energy difference onset detection function
+     * @param buffer a pointer to the audio samples
+     * @param numSamples the number of samples in the buffer
+     * @returns the energy difference onset detection function sample for the frame
+     */
+    T energyDifference (const T* buffer, size_t numSamples);
+
+    /** calculates the energy difference onset detection function sample from the
+     * energy (sum of squared samples) of the frame, when that is already known
+     * @param energy the sum of the squared samples of the frame
+     */
+    T energyDifferenceFromEnergy (T energy);
+
     //===========================================================
     /** calculates the spectral difference between the current magnitude
      * spectrum and the previous magnitude spectrum
@@ -71,13 +87,25 @@ public:
 
     //===========================================================
     /** calculates the complex spectral difference from the real and imaginary parts 
-     * of the FFT
+     * of the FFT. Rather than unwrapping the phase of each bin, the phase predicted
+     * from the previous two frames is applied by complex multiplication with their
+     * unit phasors, so the bins are processed a vector at a time without atan2 or sin.
+     * Given the frameSize / 2 + 1 bins of the half spectrum of a real frame, the bins whose
+     * mirror images are left out count twice, which gives the same result as the full spectrum
      * @param fftReal a vector containing the real part of the FFT
      * @param fftImag a vector containing the imaginary part of the FFT
      * @returns the complex spectral difference onset detection function sample
      */
     T complexSpectralDifference (const std::vector<T>& fftReal, const std::vector<T>& fftImag);
 
+    /** calculates the complex spectral difference from the real and imaginary parts of the FFT
+     * @param fftReal a pointer to the real part of the FFT
+     * @param fftImag a pointer to the imaginary part of the FFT
+     * @param numBins the number of bins in fftReal and fftImag
+     * @returns the complex spectral difference onset detection function sample
+     */
+    T complexSpectralDifference (const T* fftReal, const T* fftImag, size_t numBins);
+
     //===========================================================
     /** calculates the high frequency content onset detection function from
      * the magnitude spectrum
@@ -86,11 +114,71 @@ public:
      */
     T highFrequencyContent (const std::vector<T>& magnitudeSpectrum);
 
+    //===========================================================
+    /** the spectral onset detection function samples for one frame, calculated together */
+    struct Samples
+    {
+        T spectralDifference;           /**< as returned by spectralDifference() */
+        T spectralDifferenceHWR;        /**< as returned by spectralDifferenceHWR() */
+        T complexSpectralDifference;    /**< as returned by complexSpectralDifference() */
+        T highFrequencyContent;         /**< as returned by highFrequencyContent() */
+    };
+
+    /** calculates the spectral difference, HWR spectral difference, complex spectral difference and
+     * high frequency content in one pass over the spectrum. The three differences share a single
+     * previous magnitude spectrum and phase history, kept apart from the histories used by the
+     * individual functions, so a stream of frames should be analysed with either this or those.
+     * As in complexSpectralDifference(), a half spectrum gives the complex spectral difference of the full spectrum.
+     * @param magnitudeSpectrum the magnitude spectrum, which must be the magnitudes of the first bins of fftReal and fftImag
+     * @param fftReal a vector containing the real part of the FFT
+     * @param fftImag a vector containing the imaginary part of the FFT
+     * @returns the onset detection function samples for the frame
+     */
+    Samples computeAll (const std::vector<T>& magnitudeSpectrum, const std::vector<T>& fftReal, const std::vector<T>& fftImag);
+
+    /** calculates the spectral onset detection function samples in one pass, as computeAll() above
+     * @param magnitudeSpectrum the magnitude spectrum, which must be the magnitudes of the first bins of fftReal and fftImag
+     * @param fftReal a pointer to the real part of the FFT
+     * @param fftImag a pointer to the imaginary part of the FFT
+     * @param numComplexBins the number of bins in fftReal and fftImag
+     * @returns the onset detection function samples for the frame
+     */
+    Samples computeAll (const std::vector<T>& magnitudeSpectrum, const T* fftReal, const T* fftImag, size_t numComplexBins);
+
 private:
-    /** maps phasein into the [-pi:pi] range */
-    T princarg (T phaseVal);
+    //===========================================================
+    /** the previous magnitude and the unit phasors of the previous two frames for each bin */
+    struct SpectralHistory
+    {
+        std::vector<T> magnitude;       /**< the magnitude of each bin in the previous frame */
+        std::vector<T> phasorReal;      /**< the real part of the unit phasor of each bin in the previous frame */
+        std::vector<T> phasorImag;      /**< the imaginary part of the unit phasor of each bin in the previous frame */
+        std::vector<T> phasor2Real;     /**< the real part of the unit phasor of each bin two frames ago */
+        std::vector<T> phasor2Imag;     /**< the imaginary part of the unit phasor of each bin two frames ago */
+    };
+
+    /** adds the sums of the spectral differences kernel for bins begin to end - 1, counting the complex spectral
+     * difference of each bin twice if numComplexBins is a half spectrum that leaves out the bin's mirror image */
+    void addSpectralDifferences (const T* magnitudeSpectrum, const T* fftReal, const T* fftImag,
+                                 const SpectralHistoryPointers<T>& history, size_t begin, size_t end,
+                                 size_t numComplexBins, T* sums);
+
+    /** resizes a history to the given number of bins, filling it with the initial value, if it is not already that size */
+    static void prepareHistory (std::vector<T>& history, size_t numBins, T initialValue = 0);
+
+    /** resizes a spectral history to the given number of bins, starting from zero magnitudes and phases, if it is not already that size */
+    static void prepareSpectralHistory (SpectralHistory& history, size_t numBins);
+
+    /** @returns pointers to the vectors of a spectral history, for the kernels in SimdKernels */
+    static SpectralHistoryPointers<T> getHistoryPointers (SpectralHistory& history);
+
+    /** clears a spectral history, so that it is sized afresh when next used */
+    static void clearSpectralHistory (SpectralHistory& history);
 
     //===========================================================
+    /** the frame size, which tells a half spectrum from a full one */
+    int frameSize;
+
     /** holds the previous energy sum for the energy difference onset detection function */
     T prevEnergySum;
 
@@ -102,17 +190,13 @@ private:
      last spectral difference (half wave rectified) call */
     std::vector<T> prevMagnitudeSpectrum_spectralDifferenceHWR;
 
-    /** a vector containing the previous phase spectrum passed to the
-     last complex spectral difference call */
-    std::vector<T> prevPhaseSpectrum_complexSpectralDifference;
+    /** the magnitudes and phasors of the spectra passed to the last
+     complex spectral difference calls */
+    SpectralHistory history_complexSpectralDifference;
 
-    /** a vector containing the second previous phase spectrum passed to the
-     last complex spectral difference call */
-    std::vector<T> prevPhaseSpectrum2_complexSpectralDifference;
-
-    /** a vector containing the previous magnitude spectrum passed to the
-     last complex spectral difference call */
-    std::vector<T> prevMagnitudeSpectrum_complexSpectralDifference;
+    /** the magnitudes and phasors of the spectra passed to the last computeAll()
+     calls, shared by its three difference functions */
+    SpectralHistory sharedHistory;
 };
 
 #endif
@@ -0,0 +1,434 @@
+//=======================================================================
+/** @file SimdFFT.cpp
+ *  @brief Performs the FFT using the built-in SIMD radix-4 implementation
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#define _USE_MATH_DEFINES
+#include "SimdFFT.h"
+#include "SimdOperations.h"
+#include <cmath>
+#include <utility>
+
+namespace
+{
+    //=======================================================================
+    /** Pointers to the twiddles of one radix-4 pass */
+    template <class T>
+    struct StageTwiddles
+    {
+        const T* w1Real;
+        const T* w1Imag;
+        const T* w2Real;
+        const T* w2Imag;
+        const T* w3Real;
+        const T* w3Imag;
+    };
+
+    //=======================================================================
+    /** The FFT passes, written once for any of the operation structs in SimdOperations.h */
+    template <class Ops, class T>
+    struct SimdFFTKernels
+    {
+        typedef typename Ops::Vector Vector;
+
+        //=======================================================================
+        static inline void complexMultiply (Vector aReal, Vector aImag, Vector bReal, Vector bImag, Vector& outReal, Vector& outImag)
+        {
+            outReal = Ops::sub (Ops::mul (aReal, bReal), Ops::mul (aImag, bImag));
+            outImag = Ops::add (Ops::mul (aReal, bImag), Ops::mul (aImag, bReal));
+        }
+
+        //=======================================================================
+        /** A decimation-in-frequency radix-4 butterfly. x holds the four inputs and
+         * w the twiddles for outputs 1 to 3, all as [real, imag] pairs. */
+        static inline void butterfly (const Vector* x, const Vector* w, Vector* y)
+        {
+            Vector aPlusCReal = Ops::add (x[0], x[4]);
+            Vector aPlusCImag = Ops::add (x[1], x[5]);
+            Vector aMinusCReal = Ops::sub (x[0], x[4]);
+            Vector aMinusCImag = Ops::sub (x[1], x[5]);
+            Vector bPlusDReal = Ops::add (x[2], x[6]);
+            Vector bPlusDImag = Ops::add (x[3], x[7]);
+            Vector bMinusDReal = Ops::sub (x[2], x[6]);
+            Vector bMinusDImag = Ops::sub (x[3], x[7]);
+
+            y[0] = Ops::add (aPlusCReal, bPlusDReal);
+            y[1] = Ops::add (aPlusCImag, bPlusDImag);
+
+            // (a - c) - j(b - d)
+            complexMultiply (Ops::add (aMinusCReal, bMinusDImag), Ops::sub (aMinusCImag, bMinusDReal), w[0], w[1], y[2], y[3]);
+
+            // (a + c) - (b + d)
+            complexMultiply (Ops::sub (aPlusCReal, bPlusDReal), Ops::sub (aPlusCImag, bPlusDImag), w[2], w[3], y[4], y[5]);
+
+            // (a - c) + j(b - d)
+            complexMultiply (Ops::sub (aMinusCReal, bMinusDImag), Ops::add (aMinusCImag, bMinusDReal), w[4], w[5], y[6], y[7]);
+        }
+
+        //=======================================================================
+        /** One Stockham radix-4 pass, reading x[q + s * (p + k * n1)] and writing
+         * y[q + s * (4 * p + k)], vectorised over q. Requires s to be a multiple of the vector width */
+        static void radix4StageOverQ (const T* srcReal, const T* srcImag, T* dstReal, T* dstImag, int n1, int s, const StageTwiddles<T>& twiddles)
+        {
+            for (int p = 0; p < n1; p++)
+            {
+                Vector w[6];
+                w[0] = Ops::set1 (twiddles.w1Real[p]);
+                w[1] = Ops::set1 (twiddles.w1Imag[p]);
+                w[2] = Ops::set1 (twiddles.w2Real[p]);
+                w[3] = Ops::set1 (twiddles.w2Imag[p]);
+                w[4] = Ops::set1 (twiddles.w3Real[p]);
+                w[5] = Ops::set1 (twiddles.w3Imag[p]);
+
+                const int inputOffset = s * p;
+                const int inputStride = s * n1;
+                const int outputOffset = s * 4 * p;
+
+                for (int q = 0; q < s; q += Ops::width)
+                {
+                    Vector x[8];
+                    Vector y[8];
+
+                    for (int k = 0; k < 4; k++)
+                    {
+                        x[2 * k] = Ops::load (srcReal + q + inputOffset + k * inputStride);
+                        x[2 * k + 1] = Ops::load (srcImag + q + inputOffset + k * inputStride);
+                    }
+
+                    butterfly (x, w, y);
+
+                    for (int k = 0; k < 4; k++)
+                    {
+                        Ops::store (dstReal + q + outputOffset + k * s, y[2 * k]);
+                        Ops::store (dstImag + q + outputOffset + k * s, y[2 * k + 1]);
+                    }
+                }
+            }
+        }
+
+        //=======================================================================
+        /** The first Stockham radix-4 pass (s = 1), vectorised over p. The outputs of
+         * neighbouring butterflies are interleaved on the way out. Requires n1 to be a
+         * multiple of the vector width */
+        static void radix4FirstStageOverP (const T* srcReal, const T* srcImag, T* dstReal, T* dstImag, int n1, const StageTwiddles<T>& twiddles)
+        {
+            for (int p = 0; p < n1; p += Ops::width)
+            {
+                Vector w[6];
+                w[0] = Ops::load (twiddles.w1Real + p);
+                w[1] = Ops::load (twiddles.w1Imag + p);
+                w[2] = Ops::load (twiddles.w2Real + p);
+                w[3] = Ops::load (twiddles.w2Imag + p);
+                w[4] = Ops::load (twiddles.w3Real + p);
+                w[5] = Ops::load (twiddles.w3Imag + p);
+
+                Vector x[8];
+                Vector y[8];
+
+                for (int k = 0; k < 4; k++)
+                {
+                    x[2 * k] = Ops::load (srcReal + p + k * n1);
+                    x[2 * k + 1] = Ops::load (srcImag + p + k * n1);
+                }
+
+                butterfly (x, w, y);
+
+                Ops::storeInterleaved4 (dstReal + 4 * p, y[0], y[2], y[4], y[6]);
+                Ops::storeInterleaved4 (dstImag + 4 * p, y[1], y[3], y[5], y[7]);
+            }
+        }
+
+        //=======================================================================
+        /** The final radix-2 pass (n = 2), used when log2 of the size is odd */
+        static void radix2FinalStage (const T* srcReal, const T* srcImag, T* dstReal, T* dstImag, int s)
+        {
+            for (int q = 0; q < s; q += Ops::width)
+            {
+                Vector aReal = Ops::load (srcReal + q);
+                Vector aImag = Ops::load (srcImag + q);
+                Vector bReal = Ops::load (srcReal + q + s);
+                Vector bImag = Ops::load (srcImag + q + s);
+
+                Ops::store (dstReal + q, Ops::add (aReal, bReal));
+                Ops::store (dstImag + q, Ops::add (aImag, bImag));
+                Ops::store (dstReal + q + s, Ops::sub (aReal, bReal));
+                Ops::store (dstImag + q + s, Ops::sub (aImag, bImag));
+            }
+        }
+
+        //=======================================================================
+        /** Splits the real frame into even samples (real part) and odd samples (imaginary part) */
+        static void packRealInput (const T* buffer, T* real, T* imag, int complexFFTSize)
+        {
+            int i = 0;
+
+            for (; i + Ops::width <= complexFFTSize; i += Ops::width)
+            {
+                Vector even, odd;
+                Ops::loadDeinterleaved (buffer + 2 * i, even, odd);
+                Ops::store (real + i, even);
+                Ops::store (imag + i, odd);
+            }
+
+            for (; i < complexFFTSize; i++)
+            {
+                real[i] = buffer[2 * i];
+                imag[i] = buffer[2 * i + 1];
+            }
+        }
+
+        //=======================================================================
+        /** Separates the spectra of the even and odd samples (Z[k] and conj (Z[M - k]))
+         * and combines them into bins 1 to M - 1 of the real spectrum */
+        static int unpackRealSpectrum (const T* zReal, const T* zImag, const T* twiddleReal, const T* twiddleImag, T* real, T* imag, int complexFFTSize)
+        {
+            const Vector half = Ops::set1 ((T)0.5);
+            int k = 1;
+
+            for (; k + Ops::width <= complexFFTSize; k += Ops::width)
+            {
+                const int mirroredIndex = complexFFTSize - k - Ops::width + 1;
+
+                Vector aReal = Ops::load (zReal + k);
+                Vector aImag = Ops::load (zImag + k);
+                Vector bReal = Ops::reverse (Ops::load (zReal + mirroredIndex));
+                Vector bImag = Ops::reverse (Ops::load (zImag + mirroredIndex));
+
+                Vector evenReal = Ops::mul (half, Ops::add (aReal, bReal));
+                Vector evenImag = Ops::mul (half, Ops::sub (aImag, bImag));
+                Vector oddReal = Ops::mul (half, Ops::add (aImag, bImag));
+                Vector oddImag = Ops::mul (half, Ops::sub (bReal, aReal));
+
+                Vector rotatedReal, rotatedImag;
+                complexMultiply (Ops::load (twiddleReal + k), Ops::load (twiddleImag + k), oddReal, oddImag, rotatedReal, rotatedImag);
+
+                Ops::store (real + k, Ops::add (evenReal, rotatedReal));
+                Ops::store (imag + k, Ops::add (evenImag, rotatedImag));
+            }
+
+            return k;
+        }
+    };
+}
+
+//=======================================================================
+template <class T>
+SimdFFT<T>::SimdFFT()
+ :  fftSize (0),
+    complexFFTSize (0)
+{
+}
+
+//=======================================================================
+template <class T>
+bool SimdFFT<T>::isFrameSizeSupported (int frameSize)
+{
+    return frameSize >= 2 && (frameSize & (frameSize - 1)) == 0;
+}
+
+//=======================================================================
+template <class T>
+void SimdFFT<T>::setAudioFrameSize (int frameSize)
+{
+    fftSize = frameSize;
+
+    if (! isFrameSizeSupported (fftSize))
+    {
+        complexFFTSize = 0;
+        plan.reset();
+        fallbackFFT.setAudioFrameSize (fftSize);
+        return;
+    }
+
+    complexFFTSize = fftSize / 2;
+
+    FFTPlanCache::PlanKey key (SimdFFTBackend, fftSize, sizeof (T), ForwardFFT);
+    int numFFTSamples = fftSize;
+
+    plan = FFTPlanCache::getPlan<Plan> (key, [numFFTSamples]()
+    {
+        return createPlan (numFFTSamples);
+    },
+    [] (Plan* planToDestroy)
+    {
+        delete planToDestroy;
+    });
+
+    for (int i = 0; i < 2; i++)
+    {
+        workReal[i].resize (complexFFTSize);
+        workImag[i].resize (complexFFTSize);
+    }
+}
+
+//=======================================================================
+template <class T>
+typename SimdFFT<T>::Plan* SimdFFT<T>::createPlan (int numFFTSamples)
+{
+    Plan* newPlan = new Plan();
+    int numComplexSamples = numFFTSamples / 2;
+
+    // one radix-4 pass per factor of 4 in the complex FFT size, with a final
+    // radix-2 pass left over when the size is an odd power of two
+    int n = numComplexSamples;
+
+    while (n >= 4)
+    {
+        int n1 = n / 4;
+        Stage stage;
+        stage.w1Real.resize (n1);
+        stage.w1Imag.resize (n1);
+        stage.w2Real.resize (n1);
+        stage.w2Imag.resize (n1);
+        stage.w3Real.resize (n1);
+        stage.w3Imag.resize (n1);
+
+        for (int p = 0; p < n1; p++)
+        {
+            double phase = -2. * M_PI * ((double)p) / ((double)n);
+            stage.w1Real[p] = (T)cos (phase);
+            stage.w1Imag[p] = (T)sin (phase);
+            stage.w2Real[p] = (T)cos (2. * phase);
+            stage.w2Imag[p] = (T)sin (2. * phase);
+            stage.w3Real[p] = (T)cos (3. * phase);
+            stage.w3Imag[p] = (T)sin (3. * phase);
+        }
+
+        newPlan->stages.push_back (stage);
+        n = n1;
+    }
+
+    newPlan->finalRadix2Stage = (n == 2);
+
+    newPlan->realFFTTwiddlesReal.resize (numComplexSamples);
+    newPlan->realFFTTwiddlesImag.resize (numComplexSamples);
+
+    for (int i = 0; i < numComplexSamples; i++)
+    {
+        double phase = -2. * M_PI * ((double)i) / ((double)numFFTSamples);
+        newPlan->realFFTTwiddlesReal[i] = (T)cos (phase);
+        newPlan->realFFTTwiddlesImag[i] = (T)sin (phase);
+    }
+
+    return newPlan;
+}
+
+//=======================================================================
+template <class T>
+void SimdFFT<T>::performFFT (const T* buffer, T* real, T* imag)
+{
+    typedef typename NativeOperations<T>::Type Ops;
+    typedef SimdFFTKernels<Ops, T> Kernels;
+    typedef SimdFFTKernels<ScalarOperations<T>, T> ScalarKernels;
+
+    if (plan == nullptr)
+    {
+        fallbackFFT.performFFT (buffer, real, imag);
+        return;
+    }
+
+    T* srcReal = workReal[0].data();
+    T* srcImag = workImag[0].data();
+    T* dstReal = workReal[1].data();
+    T* dstImag = workImag[1].data();
+
+    Kernels::packRealInput (buffer, srcReal, srcImag, complexFFTSize);
+
+    int n = complexFFTSize;
+    int s = 1;
+
+    for (size_t i = 0; i < plan->stages.size(); i++)
+    {
+        const Stage& stage = plan->stages[i];
+        StageTwiddles<T> twiddles = { stage.w1Real.data(), stage.w1Imag.data(), stage.w2Real.data(), stage.w2Imag.data(), stage.w3Real.data(), stage.w3Imag.data() };
+        int n1 = n / 4;
+
+        if (s % Ops::width == 0)
+            Kernels::radix4StageOverQ (srcReal, srcImag, dstReal, dstImag, n1, s, twiddles);
+        else if (s == 1 && n1 % Ops::width == 0)
+            Kernels::radix4FirstStageOverP (srcReal, srcImag, dstReal, dstImag, n1, twiddles);
+        else
+            ScalarKernels::radix4StageOverQ (srcReal, srcImag, dstReal, dstImag, n1, s, twiddles);
+
+        std::swap (srcReal, dstReal);
+        std::swap (srcImag, dstImag);
+        n = n1;
+        s *= 4;
+    }
+
+    if (plan->finalRadix2Stage)
+    {
+        if (s % Ops::width == 0)
+            Kernels::radix2FinalStage (srcReal, srcImag, dstReal, dstImag, s);
+        else
+            ScalarKernels::radix2FinalStage (srcReal, srcImag, dstReal, dstImag, s);
+
+        std::swap (srcReal, dstReal);
+        std::swap (srcImag, dstImag);
+    }
+
+    // the DC and Nyquist bins are purely real
+    real[0] = srcReal[0] + srcImag[0];
+    imag[0] = 0;
+    real[complexFFTSize] = srcReal[0] - srcImag[0];
+    imag[complexFFTSize] = 0;
+
+    const T* twiddleReal = plan->realFFTTwiddlesReal.data();
+    const T* twiddleImag = plan->realFFTTwiddlesImag.data();
+    int k = Kernels::unpackRealSpectrum (srcReal, srcImag, twiddleReal, twiddleImag, real, imag, complexFFTSize);
+
+    for (; k < complexFFTSize; k++)
+    {
+        int mirroredIndex = complexFFTSize - k;
+
+        T evenReal = (T)0.5 * (srcReal[k] + srcReal[mirroredIndex]);
+        T evenImag = (T)0.5 * (srcImag[k] - srcImag[mirroredIndex]);
+        T oddReal = (T)0.5 * (srcImag[k] + srcImag[mirroredIndex]);
+        T oddImag = (T)-0.5 * (srcReal[k] - srcReal[mirroredIndex]);
+
+        real[k] = evenReal + (twiddleReal[k] * oddReal - twiddleImag[k] * oddImag);
+        imag[k] = evenImag + (twiddleReal[k] * oddImag + twiddleImag[k] * oddReal);
+    }
+}
+
+//=======================================================================
+template <class T>
+const char* SimdFFT<T>::getInstructionSetName()
+{
+    typedef typename NativeOperations<T>::Type Ops;
+
+    if (Ops::width == 1)
+        return "scalar";
+
+#if GIST_SIMD_AVX
+    return "AVX";
+#elif GIST_SIMD_SSE2
+    return "SSE2";
+#elif GIST_SIMD_NEON
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+//===========================================================
+template class SimdFFT<float>;
+template class SimdFFT<double>;
@@ -0,0 +1,103 @@
+//=======================================================================
+/** @file SimdFFT.h
+ *  @brief Performs the FFT using the built-in SIMD radix-4 implementation
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __SimdFFT__
+#define __SimdFFT__
+
+#include <vector>
+#include <memory>
+#include "FFTPlanCache.h"
+#include "FFTEngine.h"
+#include "KissFFT.h"
+
+//===========================================================
+/** Performs the FFT of power-of-two frame sizes using a radix-4 Stockham
+ * FFT on split real and imaginary arrays. The butterflies are vectorised
+ * with SSE2, AVX or NEON depending on the instruction sets enabled at
+ * compile time, falling back to scalar code otherwise.
+ *
+ * The real input is packed into a complex FFT of half the size, so a frame
+ * of N samples costs one N/2 point complex FFT plus an O(N) unpacking pass.
+ * The twiddle tables are shared between all SimdFFT objects of the same
+ * size through the FFTPlanCache. Frame sizes that are not a power of two
+ * are passed on to Kiss FFT */
+template <class T>
+class SimdFFT : public FFTEngine<T>
+{
+public:
+
+    //===========================================================
+    SimdFFT();
+
+    //===========================================================
+    /** @returns true if the frame size is handled by the SIMD code (a power of two, at least 2) */
+    static bool isFrameSizeSupported (int frameSize);
+
+    /** Sets the audio frame size to be used in the FFT */
+    void setAudioFrameSize (int frameSize) override;
+
+    /** Performs the FFT of a real-valued frame
+     * @param buffer the real-valued input frame
+     * @param real the real part of the non-redundant bins (frameSize / 2 + 1 values)
+     * @param imag the imaginary part of the non-redundant bins (frameSize / 2 + 1 values)
+     */
+    void performFFT (const T* buffer, T* real, T* imag) override;
+
+    /** @Returns the backend implementing this engine */
+    FFTBackend getBackend() const override { return SimdFFTBackend; }
+
+    /** @returns the name of the instruction set the butterflies were compiled for */
+    static const char* getInstructionSetName();
+
+private:
+
+    /** The twiddles for one radix-4 pass, stored as split arrays */
+    struct Stage
+    {
+        std::vector<T> w1Real, w1Imag;
+        std::vector<T> w2Real, w2Imag;
+        std::vector<T> w3Real, w3Imag;
+    };
+
+    /** The immutable part of the FFT for one frame size */
+    struct Plan
+    {
+        std::vector<Stage> stages;            /**< one entry per radix-4 pass */
+        bool finalRadix2Stage;                /**< true if log2 of the complex FFT size is odd */
+        std::vector<T> realFFTTwiddlesReal;   /**< twiddles used to unpack the half size complex FFT */
+        std::vector<T> realFFTTwiddlesImag;
+    };
+
+    static Plan* createPlan (int fftSize);
+
+    int fftSize;
+    int complexFFTSize;
+
+    std::shared_ptr<Plan> plan;
+    std::vector<T> workReal[2];
+    std::vector<T> workImag[2];
+
+    KissFFT<T> fallbackFFT; /**< used for frame sizes that are not a power of two */
+};
+
+#endif /* __SimdFFT__ */
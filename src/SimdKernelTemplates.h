@@ -0,0 +1,416 @@
+//=======================================================================
+/** @file SimdKernelTemplates.h
+ *  @brief The kernels of SimdKernels, written once over the operation structs in SimdOperations.h
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __SimdKernelTemplates__
+#define __SimdKernelTemplates__
+
+// Included only by the SimdKernels*.cpp files, after SimdOperations.h. Like the operation
+// structs, everything here goes into GIST_SIMD_NAMESPACE when it is defined, and it keeps
+// to raw arithmetic (no inline library functions) so that no code built for one instruction
+// set can be shared by the linker with a translation unit built for another.
+
+#include "SimdKernels.h"
+
+#ifdef GIST_SIMD_NAMESPACE
+namespace GIST_SIMD_NAMESPACE
+{
+#endif
+
+//=======================================================================
+/** The kernels for one operation struct. Each processes whole vectors and then
+ * finishes the values left over with the same code over ScalarOperations */
+template <class Ops, class T>
+struct SimdKernelTemplates
+{
+    typedef typename Ops::Vector Vector;
+    typedef SimdKernelTemplates<ScalarOperations<T>, T> Scalar;
+
+    //=======================================================================
+    static T sumLanes (Vector v)
+    {
+        T lanes[16];
+        Ops::store (lanes, v);
+
+        T sum = 0;
+
+        for (int j = 0; j < Ops::width; j++)
+            sum += lanes[j];
+
+        return sum;
+    }
+
+    static T maxLanes (Vector v)
+    {
+        T lanes[16];
+        Ops::store (lanes, v);
+
+        T maxValue = lanes[0];
+
+        for (int j = 1; j < Ops::width; j++)
+            maxValue = lanes[j] > maxValue ? lanes[j] : maxValue;
+
+        return maxValue;
+    }
+
+    static Vector absolute (Vector v)
+    {
+        return Ops::max (v, Ops::sub (Ops::set1 (0), v));
+    }
+
+    //=======================================================================
+    static void multiply (const T* a, const T* b, T* result, size_t numValues)
+    {
+        size_t i = 0;
+
+        for (; i + Ops::width <= numValues; i += Ops::width)
+            Ops::store (result + i, Ops::mul (Ops::load (a + i), Ops::load (b + i)));
+
+        for (; i < numValues; i++)
+            result[i] = a[i] * b[i];
+    }
+
+    //=======================================================================
+    static void powerSpectrum (const T* real, const T* imag, T* result, size_t numBins)
+    {
+        size_t i = 0;
+
+        for (; i + Ops::width <= numBins; i += Ops::width)
+        {
+            Vector re = Ops::load (real + i);
+            Vector im = Ops::load (imag + i);
+            Ops::store (result + i, Ops::add (Ops::mul (re, re), Ops::mul (im, im)));
+        }
+
+        for (; i < numBins; i++)
+            result[i] = (real[i] * real[i]) + (imag[i] * imag[i]);
+    }
+
+    //=======================================================================
+    static void squareRoot (const T* values, T* result, size_t numValues)
+    {
+        size_t i = 0;
+
+        for (; i + Ops::width <= numValues; i += Ops::width)
+            Ops::store (result + i, Ops::sqrt (Ops::load (values + i)));
+
+        for (; i < numValues; i++)
+            result[i] = ScalarOperations<T>::sqrt (values[i]);
+    }
+
+    //=======================================================================
+    static T dotProduct (const T* a, const T* b, size_t numValues)
+    {
+        Vector sum = Ops::set1 (0);
+        size_t i = 0;
+
+        for (; i + Ops::width <= numValues; i += Ops::width)
+            sum = Ops::add (sum, Ops::mul (Ops::load (a + i), Ops::load (b + i)));
+
+        T total = sumLanes (sum);
+
+        for (; i < numValues; i++)
+            total += a[i] * b[i];
+
+        return total;
+    }
+
+    //=======================================================================
+    static T squaredDifferenceSum (const T* a, const T* b, size_t numValues)
+    {
+        Vector sum = Ops::set1 (0);
+        size_t i = 0;
+
+        for (; i + Ops::width <= numValues; i += Ops::width)
+        {
+            Vector difference = Ops::sub (Ops::load (a + i), Ops::load (b + i));
+            sum = Ops::add (sum, Ops::mul (difference, difference));
+        }
+
+        T total = sumLanes (sum);
+
+        for (; i < numValues; i++)
+        {
+            T difference = a[i] - b[i];
+            total += difference * difference;
+        }
+
+        return total;
+    }
+
+    //=======================================================================
+    static void slideDifferenceSums (T* sums, const T* oldSamples, const T* newSamples, size_t numLags)
+    {
+        const Vector oldSample = Ops::set1 (oldSamples[0]);
+        const Vector newSample = Ops::set1 (newSamples[0]);
+        size_t tau = 0;
+
+        for (; tau + Ops::width <= numLags; tau += Ops::width)
+        {
+            Vector oldDiff = Ops::sub (oldSample, Ops::load (oldSamples + tau));
+            Vector newDiff = Ops::sub (newSample, Ops::load (newSamples + tau));
+            Vector change = Ops::sub (Ops::mul (newDiff, newDiff), Ops::mul (oldDiff, oldDiff));
+            Ops::store (sums + tau, Ops::add (Ops::load (sums + tau), change));
+        }
+
+        for (; tau < numLags; tau++)
+        {
+            T oldDiff = oldSamples[0] - oldSamples[tau];
+            T newDiff = newSamples[0] - newSamples[tau];
+            sums[tau] += (newDiff * newDiff) - (oldDiff * oldDiff);
+        }
+    }
+
+    //=======================================================================
+    static void spectralSums (const T* spectrum, size_t numBins, T* sums)
+    {
+        T initialIndices[16];
+
+        for (int j = 0; j < Ops::width; j++)
+            initialIndices[j] = (T)j;
+
+        Vector index = Ops::load (initialIndices);
+        const Vector indexStep = Ops::set1 ((T)Ops::width);
+
+        Vector sum = Ops::set1 (0);
+        Vector weightedSum = Ops::set1 (0);
+        Vector sumOfSquares = Ops::set1 (0);
+        Vector maxSquare = Ops::set1 (0);
+        size_t i = 0;
+
+        for (; i + Ops::width <= numBins; i += Ops::width)
+        {
+            Vector v = Ops::load (spectrum + i);
+            Vector square = Ops::mul (v, v);
+
+            sum = Ops::add (sum, v);
+            weightedSum = Ops::add (weightedSum, Ops::mul (v, index));
+            sumOfSquares = Ops::add (sumOfSquares, square);
+            maxSquare = Ops::max (maxSquare, square);
+            index = Ops::add (index, indexStep);
+        }
+
+        sums[0] = sumLanes (sum);
+        sums[1] = sumLanes (weightedSum);
+        sums[2] = sumLanes (sumOfSquares);
+        sums[3] = maxLanes (maxSquare);
+
+        for (; i < numBins; i++)
+        {
+            T v = spectrum[i];
+            sums[0] += v;
+            sums[1] += v * (T)i;
+            sums[2] += v * v;
+            sums[3] = v * v > sums[3] ? v * v : sums[3];
+        }
+    }
+
+    //=======================================================================
+    static void centralMoments (const T* spectrum, size_t numBins, T mean, T* moments)
+    {
+        const Vector meanVector = Ops::set1 (mean);
+        Vector moment2 = Ops::set1 (0);
+        Vector moment4 = Ops::set1 (0);
+        size_t i = 0;
+
+        for (; i + Ops::width <= numBins; i += Ops::width)
+        {
+            Vector difference = Ops::sub (Ops::load (spectrum + i), meanVector);
+            Vector squaredDifference = Ops::mul (difference, difference);
+            moment2 = Ops::add (moment2, squaredDifference);
+            moment4 = Ops::add (moment4, Ops::mul (squaredDifference, squaredDifference));
+        }
+
+        moments[0] = sumLanes (moment2);
+        moments[1] = sumLanes (moment4);
+
+        for (; i < numBins; i++)
+        {
+            T difference = spectrum[i] - mean;
+            T squaredDifference = difference * difference;
+            moments[0] += squaredDifference;
+            moments[1] += squaredDifference * squaredDifference;
+        }
+    }
+
+    //=======================================================================
+    static void timeDomainStatistics (const T* buffer, size_t numSamples, T* statistics)
+    {
+        statistics[0] = 0;
+        statistics[1] = 0;
+        statistics[2] = 0;
+
+        if (numSamples == 0)
+            return;
+
+        const Vector zero = Ops::set1 (0);
+        const Vector one = Ops::set1 (1);
+
+        Vector sum = zero;
+        Vector peak = zero;
+        Vector crossings = zero;
+
+        // the first sample has nothing before it to cross zero from, so the vectors start from the second
+        size_t i = 1;
+
+        for (; i + Ops::width <= numSamples; i += Ops::width)
+        {
+            Vector sample = Ops::load (buffer + i);
+
+            sum = Ops::add (sum, Ops::mul (sample, sample));
+            peak = Ops::max (peak, absolute (sample));
+
+            // 1 for each sample above zero, so that a change between neighbours counts a crossing
+            Vector isPositive = Ops::select (Ops::greaterThan (sample, zero), one, zero);
+            Vector previousIsPositive = Ops::select (Ops::greaterThan (Ops::load (buffer + i - 1), zero), one, zero);
+            crossings = Ops::add (crossings, absolute (Ops::sub (isPositive, previousIsPositive)));
+        }
+
+        T energy = buffer[0] * buffer[0] + sumLanes (sum);
+        T peakValue = buffer[0] < 0 ? -buffer[0] : buffer[0];
+        T zcr = sumLanes (crossings);
+
+        T vectorPeak = maxLanes (peak);
+        peakValue = vectorPeak > peakValue ? vectorPeak : peakValue;
+
+        for (; i < numSamples; i++)
+        {
+            energy += buffer[i] * buffer[i];
+
+            T absSample = buffer[i] < 0 ? -buffer[i] : buffer[i];
+
+            if (absSample > peakValue)
+                peakValue = absSample;
+
+            if ((buffer[i] > 0) != (buffer[i - 1] > 0))
+                zcr = zcr + 1;
+        }
+
+        statistics[0] = energy;
+        statistics[1] = peakValue;
+        statistics[2] = zcr;
+    }
+
+    //=======================================================================
+    /** The complex spectral difference needs the deviation of each phase from the phase predicted
+     * by the previous two frames, dev = phase - 2 * phase1 + phase2, only through -magnitude * sin (dev).
+     * With u, u1 and u2 the unit phasors of the bin in this and the previous two frames, e^(j dev) is
+     * u * conj (u1)^2 * u2, so that term is -Im (X * conj (u1)^2 * u2) and no phase is ever unwrapped.
+     * A bin of zero magnitude gets the phasor 1, just as atan2 (0, 0) gives a phase of zero.
+     */
+    static void spectralDifferences (const T* magnitudeSpectrum, const T* fftReal, const T* fftImag,
+                                     const SpectralHistoryPointers<T>& history, size_t begin, size_t end, T* sums)
+    {
+        const Vector zero = Ops::set1 (0);
+        const Vector one = Ops::set1 (1);
+        const Vector two = Ops::set1 (2);
+
+        T initialIndices[16];
+
+        for (int j = 0; j < Ops::width; j++)
+            initialIndices[j] = (T)(begin + j + 1);
+
+        Vector index = Ops::load (initialIndices);
+        const Vector indexStep = Ops::set1 ((T)Ops::width);
+
+        Vector spectralDifference = zero;
+        Vector spectralDifferenceHWR = zero;
+        Vector complexSpectralDifference = zero;
+        Vector highFrequencyContent = zero;
+
+        size_t i = begin;
+
+        for (; i + Ops::width <= end; i += Ops::width)
+        {
+            Vector real = Ops::load (fftReal + i);
+            Vector imag = Ops::load (fftImag + i);
+            Vector magnitude = magnitudeSpectrum != nullptr ? Ops::load (magnitudeSpectrum + i)
+                                                            : Ops::sqrt (Ops::add (Ops::mul (real, real), Ops::mul (imag, imag)));
+
+            // magnitude difference (real part of Euclidean distance between complex frames)
+            Vector magDiff = Ops::sub (magnitude, Ops::load (history.magnitude + i));
+
+            spectralDifference = Ops::add (spectralDifference, absolute (magDiff));
+            spectralDifferenceHWR = Ops::add (spectralDifferenceHWR, Ops::max (magDiff, zero));
+            highFrequencyContent = Ops::add (highFrequencyContent, Ops::mul (magnitude, index));
+            index = Ops::add (index, indexStep);
+
+            // the predicted rotation conj (u1)^2 * u2, with conj (u1)^2 = a - jb
+            Vector u1Real = Ops::load (history.phasorReal + i);
+            Vector u1Imag = Ops::load (history.phasorImag + i);
+            Vector u2Real = Ops::load (history.phasor2Real + i);
+            Vector u2Imag = Ops::load (history.phasor2Imag + i);
+
+            Vector a = Ops::sub (Ops::mul (u1Real, u1Real), Ops::mul (u1Imag, u1Imag));
+            Vector b = Ops::mul (two, Ops::mul (u1Real, u1Imag));
+            Vector rotationReal = Ops::add (Ops::mul (a, u2Real), Ops::mul (b, u2Imag));
+            Vector rotationImag = Ops::sub (Ops::mul (a, u2Imag), Ops::mul (b, u2Real));
+
+            // phase difference (imaginary part of Euclidean distance between complex frames)
+            Vector phaseDiff = Ops::add (Ops::mul (real, rotationImag), Ops::mul (imag, rotationReal));
+
+            Vector distance = Ops::sqrt (Ops::add (Ops::mul (magDiff, magDiff), Ops::mul (phaseDiff, phaseDiff)));
+            complexSpectralDifference = Ops::add (complexSpectralDifference, distance);
+
+            // store values for next calculation
+            Vector isNonZero = Ops::greaterThan (magnitude, zero);
+            Vector divisor = Ops::select (isNonZero, magnitude, one);
+
+            Ops::store (history.phasor2Real + i, u1Real);
+            Ops::store (history.phasor2Imag + i, u1Imag);
+            Ops::store (history.phasorReal + i, Ops::select (isNonZero, Ops::div (real, divisor), one));
+            Ops::store (history.phasorImag + i, Ops::select (isNonZero, Ops::div (imag, divisor), zero));
+            Ops::store (history.magnitude + i, magnitude);
+        }
+
+        sums[0] += sumLanes (spectralDifference);
+        sums[1] += sumLanes (spectralDifferenceHWR);
+        sums[2] += sumLanes (complexSpectralDifference);
+        sums[3] += sumLanes (highFrequencyContent);
+
+        if (Ops::width > 1 && i < end)
+            Scalar::spectralDifferences (magnitudeSpectrum, fftReal, fftImag, history, i, end, sums);
+    }
+
+    //=======================================================================
+    /** Points a table at the kernels for this operation struct */
+    static void fill (SimdKernels<T>& kernels, SimdInstructionSet instructionSet)
+    {
+        kernels.instructionSet = instructionSet;
+        kernels.multiply = &multiply;
+        kernels.powerSpectrum = &powerSpectrum;
+        kernels.squareRoot = &squareRoot;
+        kernels.dotProduct = &dotProduct;
+        kernels.squaredDifferenceSum = &squaredDifferenceSum;
+        kernels.slideDifferenceSums = &slideDifferenceSums;
+        kernels.spectralSums = &spectralSums;
+        kernels.centralMoments = &centralMoments;
+        kernels.timeDomainStatistics = &timeDomainStatistics;
+        kernels.spectralDifferences = &spectralDifferences;
+    }
+};
+
+#ifdef GIST_SIMD_NAMESPACE
+}
+#endif
+
+#endif /* __SimdKernelTemplates__ */
@@ -0,0 +1,212 @@
+//=======================================================================
+/** @file SimdKernels.cpp
+ *  @brief The inner loops of the feature calculations, chosen at runtime for the CPU
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#include "SimdKernels.h"
+#include "SimdOperations.h"
+#include "SimdKernelTemplates.h"
+
+#if defined (_MSC_VER) && (defined (_M_X64) || defined (_M_IX86))
+#include <intrin.h>
+#endif
+
+// defined in SimdKernelsAVX2.cpp and SimdKernelsAVX512.cpp, which are compiled for those instruction sets
+#if GIST_AVX2_KERNELS
+void fillAVX2SimdKernels (SimdKernels<float>& floatKernels, SimdKernels<double>& doubleKernels);
+#endif
+
+#if GIST_AVX512_KERNELS
+void fillAVX512SimdKernels (SimdKernels<float>& floatKernels, SimdKernels<double>& doubleKernels);
+#endif
+
+//=======================================================================
+/** @returns true if the CPU (and the operating system, for the wider registers) supports an instruction set */
+static bool cpuSupports (SimdInstructionSet instructionSet)
+{
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+    __builtin_cpu_init();
+
+    switch (instructionSet)
+    {
+        case SSE2InstructionSet: return __builtin_cpu_supports ("sse2");
+        case AVXInstructionSet: return __builtin_cpu_supports ("avx");
+        case AVX2InstructionSet: return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+        case AVX512InstructionSet: return __builtin_cpu_supports ("avx512f");
+        default: return instructionSet == ScalarInstructionSet;
+    }
+#elif defined (_MSC_VER) && (defined (_M_X64) || defined (_M_IX86))
+    int info[4];
+    __cpuid (info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid (info, 1);
+    const bool hasSSE2 = (info[3] & (1 << 26)) != 0;
+    const bool hasFMA = (info[2] & (1 << 12)) != 0;
+    const bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+    const bool hasAVX = (info[2] & (1 << 28)) != 0;
+
+    // the operating system must save the YMM (and for AVX-512, the ZMM and mask) registers
+    const unsigned long long enabledState = hasOSXSave ? _xgetbv (0) : 0;
+    const bool osSavesYMM = (enabledState & 0x06) == 0x06;
+    const bool osSavesZMM = (enabledState & 0xe6) == 0xe6;
+
+    bool hasAVX2 = false, hasAVX512 = false;
+
+    if (maxLeaf >= 7)
+    {
+        __cpuidex (info, 7, 0);
+        hasAVX2 = (info[1] & (1 << 5)) != 0;
+        hasAVX512 = (info[1] & (1 << 16)) != 0;
+    }
+
+    switch (instructionSet)
+    {
+        case SSE2InstructionSet: return hasSSE2;
+        case AVXInstructionSet: return hasAVX && osSavesYMM;
+        case AVX2InstructionSet: return hasAVX && hasAVX2 && hasFMA && osSavesYMM;
+        case AVX512InstructionSet: return hasAVX512 && osSavesZMM;
+        default: return instructionSet == ScalarInstructionSet;
+    }
+#else
+    // the baseline instruction set is all that is built in elsewhere
+    (void) instructionSet;
+    return true;
+#endif
+}
+
+//=======================================================================
+/** The instruction set the library as a whole is compiled for */
+static SimdInstructionSet getBaselineInstructionSet()
+{
+#if GIST_SIMD_AVX
+    return AVXInstructionSet;
+#elif GIST_SIMD_SSE2
+    return SSE2InstructionSet;
+#elif GIST_SIMD_NEON
+    return NEONInstructionSet;
+#else
+    return ScalarInstructionSet;
+#endif
+}
+
+//=======================================================================
+/** Every table built in, and whether this CPU can run it, worked out once */
+struct SimdKernelTables
+{
+    SimdKernelTables()
+    {
+        for (int i = 0; i < NumSimdInstructionSets; i++)
+            isAvailable[i] = false;
+
+        SimdKernelTemplates<ScalarOperations<float>, float>::fill (floatKernels[ScalarInstructionSet], ScalarInstructionSet);
+        SimdKernelTemplates<ScalarOperations<double>, double>::fill (doubleKernels[ScalarInstructionSet], ScalarInstructionSet);
+        isAvailable[ScalarInstructionSet] = true;
+
+        SimdInstructionSet baseline = getBaselineInstructionSet();
+        SimdKernelTemplates<NativeOperations<float>::Type, float>::fill (floatKernels[baseline], baseline);
+        SimdKernelTemplates<NativeOperations<double>::Type, double>::fill (doubleKernels[baseline], baseline);
+        isAvailable[baseline] = true;
+
+#if GIST_AVX2_KERNELS
+        if (cpuSupports (AVX2InstructionSet))
+        {
+            fillAVX2SimdKernels (floatKernels[AVX2InstructionSet], doubleKernels[AVX2InstructionSet]);
+            isAvailable[AVX2InstructionSet] = true;
+        }
+#endif
+
+#if GIST_AVX512_KERNELS
+        if (cpuSupports (AVX512InstructionSet))
+        {
+            fillAVX512SimdKernels (floatKernels[AVX512InstructionSet], doubleKernels[AVX512InstructionSet]);
+            isAvailable[AVX512InstructionSet] = true;
+        }
+#endif
+
+        // the widest one available, which is the last in the enum order bar NEON (only ever the baseline)
+        best = baseline;
+
+        for (int i = baseline + 1; i <= AVX512InstructionSet; i++)
+        {
+            if (isAvailable[i])
+                best = static_cast<SimdInstructionSet> (i);
+        }
+    }
+
+    static const SimdKernelTables& get()
+    {
+        static const SimdKernelTables tables;
+        return tables;
+    }
+
+    const SimdKernels<float>& getKernels (SimdInstructionSet instructionSet, float*) const { return floatKernels[instructionSet]; }
+    const SimdKernels<double>& getKernels (SimdInstructionSet instructionSet, double*) const { return doubleKernels[instructionSet]; }
+
+    SimdKernels<float> floatKernels[NumSimdInstructionSets];
+    SimdKernels<double> doubleKernels[NumSimdInstructionSets];
+    bool isAvailable[NumSimdInstructionSets];
+    SimdInstructionSet best;
+};
+
+//=======================================================================
+template <class T>
+const SimdKernels<T>& SimdKernels<T>::get()
+{
+    // the choice is made once; after that this is one guarded load
+    static const SimdKernels<T>& kernels = SimdKernelTables::get().getKernels (SimdKernelTables::get().best, (T*) nullptr);
+    return kernels;
+}
+
+//=======================================================================
+template <class T>
+const SimdKernels<T>* SimdKernels<T>::find (SimdInstructionSet instructionSet)
+{
+    if (instructionSet < 0 || instructionSet >= NumSimdInstructionSets)
+        return nullptr;
+
+    const SimdKernelTables& tables = SimdKernelTables::get();
+
+    if (! tables.isAvailable[instructionSet])
+        return nullptr;
+
+    return &tables.getKernels (instructionSet, (T*) nullptr);
+}
+
+//=======================================================================
+template <class T>
+const char* SimdKernels<T>::getName (SimdInstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+        case ScalarInstructionSet: return "Scalar";
+        case SSE2InstructionSet: return "SSE2";
+        case AVXInstructionSet: return "AVX";
+        case AVX2InstructionSet: return "AVX2";
+        case AVX512InstructionSet: return "AVX-512";
+        case NEONInstructionSet: return "NEON";
+        default: return "Unknown";
+    }
+}
+
+//===========================================================
+template struct SimdKernels<float>;
+template struct SimdKernels<double>;
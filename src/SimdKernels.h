@@ -0,0 +1,121 @@
+//=======================================================================
+/** @file SimdKernels.h
+ *  @brief The inner loops of the feature calculations, chosen at runtime for the CPU
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __SimdKernels__
+#define __SimdKernels__
+
+#include <stddef.h>
+
+//=======================================================================
+/** The instruction sets the kernels can be built for */
+enum SimdInstructionSet
+{
+    ScalarInstructionSet,
+    SSE2InstructionSet,
+    AVXInstructionSet,
+    AVX2InstructionSet,
+    AVX512InstructionSet,
+    NEONInstructionSet,
+    NumSimdInstructionSets
+};
+
+//=======================================================================
+/** Pointers to the previous magnitudes and unit phasors of the last two frames of each bin,
+ * as kept by OnsetDetectionFunction for its spectral difference functions */
+template <class T>
+struct SpectralHistoryPointers
+{
+    T* magnitude;       /**< the magnitude of each bin in the previous frame */
+    T* phasorReal;      /**< the real part of the unit phasor of each bin in the previous frame */
+    T* phasorImag;      /**< the imaginary part of the unit phasor of each bin in the previous frame */
+    T* phasor2Real;     /**< the real part of the unit phasor of each bin two frames ago */
+    T* phasor2Imag;     /**< the imaginary part of the unit phasor of each bin two frames ago */
+};
+
+//=======================================================================
+/** A table of the inner loops behind the features, all built for one instruction set.
+ *
+ * Gist is compiled for a baseline instruction set (SSE2 on x86-64, NEON on ARM), and
+ * where the compiler supports it the same kernels are also compiled into translation
+ * units of their own for AVX2 and AVX-512. get() checks the CPU once, on first use, and
+ * returns the widest table it can run, so one build runs at full speed on older and newer
+ * machines alike.
+ *
+ * Instantiations of the class should be of either 'float' or 'double' types and no others
+ */
+template <class T>
+struct SimdKernels
+{
+    //=======================================================================
+    /** @returns the kernels for the widest instruction set both built in and supported by this CPU */
+    static const SimdKernels<T>& get();
+
+    /** @returns the kernels for an instruction set, or nullptr if they are not built in or this CPU does not support them */
+    static const SimdKernels<T>* find (SimdInstructionSet instructionSet);
+
+    /** @returns the name of an instruction set, e.g. "AVX2" */
+    static const char* getName (SimdInstructionSet instructionSet);
+
+    //=======================================================================
+    /** The instruction set the kernels were built for */
+    SimdInstructionSet instructionSet;
+
+    /** result[i] = a[i] * b[i] (e.g. the windowing of a frame) */
+    void (*multiply) (const T* a, const T* b, T* result, size_t numValues);
+
+    /** result[i] = real[i]^2 + imag[i]^2 */
+    void (*powerSpectrum) (const T* real, const T* imag, T* result, size_t numBins);
+
+    /** result[i] = sqrt (values[i]) */
+    void (*squareRoot) (const T* values, T* result, size_t numValues);
+
+    /** @returns the sum of a[i] * b[i] */
+    T (*dotProduct) (const T* a, const T* b, size_t numValues);
+
+    /** @returns the sum of (a[i] - b[i])^2 */
+    T (*squaredDifferenceSum) (const T* a, const T* b, size_t numValues);
+
+    /** sums[tau] += (newSamples[0] - newSamples[tau])^2 - (oldSamples[0] - oldSamples[tau])^2,
+     * the update of the Yin difference function for one sample of hop */
+    void (*slideDifferenceSums) (T* sums, const T* oldSamples, const T* newSamples, size_t numLags);
+
+    /** Calculates the sum, index-weighted sum, sum of squares and largest square of a spectrum
+     * @param sums the four results, in that order */
+    void (*spectralSums) (const T* spectrum, size_t numBins, T* sums);
+
+    /** Calculates the sums of the second and fourth powers of the differences from the mean
+     * @param moments the two results, in that order */
+    void (*centralMoments) (const T* spectrum, size_t numBins, T mean, T* moments);
+
+    /** Calculates the energy (sum of squares), peak (largest absolute value) and number of zero crossings of a buffer
+     * @param statistics the three results, in that order */
+    void (*timeDomainStatistics) (const T* buffer, size_t numSamples, T* statistics);
+
+    /** Adds the spectral difference, HWR spectral difference, complex spectral difference and high frequency content
+     * of bins begin to end - 1 to the four sums, in that order, and moves the history on to this frame
+     * @param magnitudeSpectrum the magnitudes of the bins, or nullptr to calculate them from the FFT */
+    void (*spectralDifferences) (const T* magnitudeSpectrum, const T* fftReal, const T* fftImag,
+                                 const SpectralHistoryPointers<T>& history, size_t begin, size_t end, T* sums);
+};
+
+#endif /* __SimdKernels__ */
@@ -0,0 +1,40 @@
+//=======================================================================
+/** @file SimdKernelsAVX2.cpp
+ *  @brief The kernels of SimdKernels, compiled for AVX2 (and FMA)
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+// The build compiles this file alone with the AVX2 (and FMA) flags, and defines
+// GIST_AVX2_KERNELS when it does. Nothing in it may run until SimdKernels
+// has checked that the CPU supports the instruction set.
+#if GIST_AVX2_KERNELS
+
+#define GIST_SIMD_NAMESPACE GistAVX2
+#include "SimdOperations.h"
+#include "SimdKernelTemplates.h"
+
+//=======================================================================
+void fillAVX2SimdKernels (SimdKernels<float>& floatKernels, SimdKernels<double>& doubleKernels)
+{
+    GistAVX2::SimdKernelTemplates<GistAVX2::AVXFloatOperations, float>::fill (floatKernels, AVX2InstructionSet);
+    GistAVX2::SimdKernelTemplates<GistAVX2::AVXDoubleOperations, double>::fill (doubleKernels, AVX2InstructionSet);
+}
+
+#endif
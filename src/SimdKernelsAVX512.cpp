@@ -0,0 +1,40 @@
+//=======================================================================
+/** @file SimdKernelsAVX512.cpp
+ *  @brief The kernels of SimdKernels, compiled for AVX-512
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+// The build compiles this file alone with the AVX-512 flags, and defines
+// GIST_AVX512_KERNELS when it does. Nothing in it may run until SimdKernels
+// has checked that the CPU supports the instruction set.
+#if GIST_AVX512_KERNELS
+
+#define GIST_SIMD_NAMESPACE GistAVX512
+#include "SimdOperations.h"
+#include "SimdKernelTemplates.h"
+
+//=======================================================================
+void fillAVX512SimdKernels (SimdKernels<float>& floatKernels, SimdKernels<double>& doubleKernels)
+{
+    GistAVX512::SimdKernelTemplates<GistAVX512::AVX512FloatOperations, float>::fill (floatKernels, AVX512InstructionSet);
+    GistAVX512::SimdKernelTemplates<GistAVX512::AVX512DoubleOperations, double>::fill (doubleKernels, AVX512InstructionSet);
+}
+
+#endif
@@ -0,0 +1,479 @@
+//=======================================================================
+/** @file SimdOperations.h
+ *  @brief Thin wrappers around SSE2, AVX and NEON vector instructions
+ *  @author Adam Stark
+ *  @copyright Copyright (C) 2013  Adam Stark
+ *
+ * This file is part of the 'Gist' audio analysis library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//=======================================================================
+
+#ifndef __SimdOperations__
+#define __SimdOperations__
+
+#include <cmath>
+
+#if defined (__AVX512F__)
+#define GIST_SIMD_AVX512 1
+#endif
+
+#if defined (__AVX__)
+#define GIST_SIMD_AVX 1
+#include <immintrin.h>
+#elif defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GIST_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#define GIST_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// The kernels in SimdKernels are compiled once per instruction set, in translation units
+// built with different compiler flags. Each of those defines GIST_SIMD_NAMESPACE before
+// including this file, so that its copies of these inline functions get names of their own
+// rather than being merged by the linker with copies built for another instruction set.
+#ifdef GIST_SIMD_NAMESPACE
+namespace GIST_SIMD_NAMESPACE
+{
+#endif
+
+//=======================================================================
+/** Each *Operations struct wraps one instruction set behind the same static
+ * interface, so that kernels can be written once as templates over it:
+ *
+ *  - Vector / width: the register type and the number of T it holds
+ *  - load / store: unaligned loads and stores of 'width' values
+ *  - set1, add, sub, mul, div, max, sqrt: broadcast and element-wise arithmetic
+ *  - greaterThan / select: an element-wise comparison giving a mask, and picking
+ *    elements from a where the mask is set and from b where it is not
+ *  - reverse: reverses the order of the elements in a vector
+ *  - loadDeinterleaved: loads 2 * width values, splitting even and odd elements
+ *  - storeInterleaved4: writes dst[4 * j + k] = yk[j] for each element j
+ *
+ * The AVX-512 structs are only used by the dispatched kernels in SimdKernels, so
+ * they leave out the shuffles (reverse and the (de)interleaving) the FFT needs.
+ */
+template <class T>
+struct ScalarOperations
+{
+    typedef T Vector;
+    static const int width = 1;
+
+    static inline Vector load (const T* p) { return *p; }
+    static inline void store (T* p, Vector v) { *p = v; }
+    static inline Vector set1 (T v) { return v; }
+    static inline Vector add (Vector a, Vector b) { return a + b; }
+    static inline Vector sub (Vector a, Vector b) { return a - b; }
+    static inline Vector mul (Vector a, Vector b) { return a * b; }
+    static inline Vector max (Vector a, Vector b) { return a > b ? a : b; }
+    static inline Vector div (Vector a, Vector b) { return a / b; }
+
+    // through the C library's sqrt rather than an inline std::sqrt overload, which the
+    // linker could otherwise share with a translation unit built for another instruction set
+    static inline Vector sqrt (Vector v) { return (T) ::sqrt ((double) v); }
+
+    static inline Vector greaterThan (Vector a, Vector b) { return a > b ? (T)1 : (T)0; }
+    static inline Vector select (Vector mask, Vector a, Vector b) { return mask != 0 ? a : b; }
+    static inline Vector reverse (Vector v) { return v; }
+
+    static inline void loadDeinterleaved (const T* p, Vector& even, Vector& odd)
+    {
+        even = p[0];
+        odd = p[1];
+    }
+
+    static inline void storeInterleaved4 (T* p, Vector y0, Vector y1, Vector y2, Vector y3)
+    {
+        p[0] = y0;
+        p[1] = y1;
+        p[2] = y2;
+        p[3] = y3;
+    }
+};
+
+#if GIST_SIMD_SSE2 || GIST_SIMD_AVX
+//=======================================================================
+/** SSE operations on 4 floats */
+struct SSEFloatOperations
+{
+    typedef __m128 Vector;
+    static const int width = 4;
+
+    static inline Vector load (const float* p) { return _mm_loadu_ps (p); }
+    static inline void store (float* p, Vector v) { _mm_storeu_ps (p, v); }
+    static inline Vector set1 (float v) { return _mm_set1_ps (v); }
+    static inline Vector add (Vector a, Vector b) { return _mm_add_ps (a, b); }
+    static inline Vector sub (Vector a, Vector b) { return _mm_sub_ps (a, b); }
+    static inline Vector mul (Vector a, Vector b) { return _mm_mul_ps (a, b); }
+    static inline Vector max (Vector a, Vector b) { return _mm_max_ps (a, b); }
+    static inline Vector div (Vector a, Vector b) { return _mm_div_ps (a, b); }
+    static inline Vector sqrt (Vector v) { return _mm_sqrt_ps (v); }
+    static inline Vector greaterThan (Vector a, Vector b) { return _mm_cmpgt_ps (a, b); }
+    static inline Vector select (Vector mask, Vector a, Vector b) { return _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b)); }
+    static inline Vector reverse (Vector v) { return _mm_shuffle_ps (v, v, _MM_SHUFFLE (0, 1, 2, 3)); }
+
+    static inline void loadDeinterleaved (const float* p, Vector& even, Vector& odd)
+    {
+        Vector a = _mm_loadu_ps (p);
+        Vector b = _mm_loadu_ps (p + 4);
+        even = _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0));
+        odd = _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1));
+    }
+
+    static inline void storeInterleaved4 (float* p, Vector y0, Vector y1, Vector y2, Vector y3)
+    {
+        _MM_TRANSPOSE4_PS (y0, y1, y2, y3);
+        _mm_storeu_ps (p, y0);
+        _mm_storeu_ps (p + 4, y1);
+        _mm_storeu_ps (p + 8, y2);
+        _mm_storeu_ps (p + 12, y3);
+    }
+};
+
+//=======================================================================
+/** SSE2 operations on 2 doubles */
+struct SSEDoubleOperations
+{
+    typedef __m128d Vector;
+    static const int width = 2;
+
+    static inline Vector load (const double* p) { return _mm_loadu_pd (p); }
+    static inline void store (double* p, Vector v) { _mm_storeu_pd (p, v); }
+    static inline Vector set1 (double v) { return _mm_set1_pd (v); }
+    static inline Vector add (Vector a, Vector b) { return _mm_add_pd (a, b); }
+    static inline Vector sub (Vector a, Vector b) { return _mm_sub_pd (a, b); }
+    static inline Vector mul (Vector a, Vector b) { return _mm_mul_pd (a, b); }
+    static inline Vector max (Vector a, Vector b) { return _mm_max_pd (a, b); }
+    static inline Vector div (Vector a, Vector b) { return _mm_div_pd (a, b); }
+    static inline Vector sqrt (Vector v) { return _mm_sqrt_pd (v); }
+    static inline Vector greaterThan (Vector a, Vector b) { return _mm_cmpgt_pd (a, b); }
+    static inline Vector select (Vector mask, Vector a, Vector b) { return _mm_or_pd (_mm_and_pd (mask, a), _mm_andnot_pd (mask, b)); }
+    static inline Vector reverse (Vector v) { return _mm_shuffle_pd (v, v, 1); }
+
+    static inline void loadDeinterleaved (const double* p, Vector& even, Vector& odd)
+    {
+        Vector a = _mm_loadu_pd (p);
+        Vector b = _mm_loadu_pd (p + 2);
+        even = _mm_unpacklo_pd (a, b);
+        odd = _mm_unpackhi_pd (a, b);
+    }
+
+    static inline void storeInterleaved4 (double* p, Vector y0, Vector y1, Vector y2, Vector y3)
+    {
+        _mm_storeu_pd (p, _mm_unpacklo_pd (y0, y1));
+        _mm_storeu_pd (p + 2, _mm_unpacklo_pd (y2, y3));
+        _mm_storeu_pd (p + 4, _mm_unpackhi_pd (y0, y1));
+        _mm_storeu_pd (p + 6, _mm_unpackhi_pd (y2, y3));
+    }
+};
+#endif
+
+#if GIST_SIMD_AVX
+//=======================================================================
+/** AVX operations on 8 floats */
+struct AVXFloatOperations
+{
+    typedef __m256 Vector;
+    static const int width = 8;
+
+    static inline Vector load (const float* p) { return _mm256_loadu_ps (p); }
+    static inline void store (float* p, Vector v) { _mm256_storeu_ps (p, v); }
+    static inline Vector set1 (float v) { return _mm256_set1_ps (v); }
+    static inline Vector add (Vector a, Vector b) { return _mm256_add_ps (a, b); }
+    static inline Vector sub (Vector a, Vector b) { return _mm256_sub_ps (a, b); }
+    static inline Vector mul (Vector a, Vector b) { return _mm256_mul_ps (a, b); }
+    static inline Vector max (Vector a, Vector b) { return _mm256_max_ps (a, b); }
+    static inline Vector div (Vector a, Vector b) { return _mm256_div_ps (a, b); }
+    static inline Vector sqrt (Vector v) { return _mm256_sqrt_ps (v); }
+    static inline Vector greaterThan (Vector a, Vector b) { return _mm256_cmp_ps (a, b, _CMP_GT_OQ); }
+    static inline Vector select (Vector mask, Vector a, Vector b) { return _mm256_blendv_ps (b, a, mask); }
+
+    static inline Vector reverse (Vector v)
+    {
+        Vector swappedHalves = _mm256_permute2f128_ps (v, v, 1);
+        return _mm256_permute_ps (swappedHalves, _MM_SHUFFLE (0, 1, 2, 3));
+    }
+
+    static inline void loadDeinterleaved (const float* p, Vector& even, Vector& odd)
+    {
+        Vector a = _mm256_loadu_ps (p);
+        Vector b = _mm256_loadu_ps (p + 8);
+        Vector low = _mm256_permute2f128_ps (a, b, 0x20);
+        Vector high = _mm256_permute2f128_ps (a, b, 0x31);
+        even = _mm256_shuffle_ps (low, high, _MM_SHUFFLE (2, 0, 2, 0));
+        odd = _mm256_shuffle_ps (low, high, _MM_SHUFFLE (3, 1, 3, 1));
+    }
+
+    static inline void storeInterleaved4 (float* p, Vector y0, Vector y1, Vector y2, Vector y3)
+    {
+        Vector t0 = _mm256_unpacklo_ps (y0, y1);
+        Vector t1 = _mm256_unpackhi_ps (y0, y1);
+        Vector t2 = _mm256_unpacklo_ps (y2, y3);
+        Vector t3 = _mm256_unpackhi_ps (y2, y3);
+        Vector r0 = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (1, 0, 1, 0));
+        Vector r1 = _mm256_shuffle_ps (t0, t2, _MM_SHUFFLE (3, 2, 3, 2));
+        Vector r2 = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (1, 0, 1, 0));
+        Vector r3 = _mm256_shuffle_ps (t1, t3, _MM_SHUFFLE (3, 2, 3, 2));
+        _mm256_storeu_ps (p, _mm256_permute2f128_ps (r0, r1, 0x20));
+        _mm256_storeu_ps (p + 8, _mm256_permute2f128_ps (r2, r3, 0x20));
+        _mm256_storeu_ps (p + 16, _mm256_permute2f128_ps (r0, r1, 0x31));
+        _mm256_storeu_ps (p + 24, _mm256_permute2f128_ps (r2, r3, 0x31));
+    }
+};
+
+//=======================================================================
+/** AVX operations on 4 doubles */
+struct AVXDoubleOperations
+{
+    typedef __m256d Vector;
+    static const int width = 4;
+
+    static inline Vector load (const double* p) { return _mm256_loadu_pd (p); }
+    static inline void store (double* p, Vector v) { _mm256_storeu_pd (p, v); }
+    static inline Vector set1 (double v) { return _mm256_set1_pd (v); }
+    static inline Vector add (Vector a, Vector b) { return _mm256_add_pd (a, b); }
+    static inline Vector sub (Vector a, Vector b) { return _mm256_sub_pd (a, b); }
+    static inline Vector mul (Vector a, Vector b) { return _mm256_mul_pd (a, b); }
+    static inline Vector max (Vector a, Vector b) { return _mm256_max_pd (a, b); }
+    static inline Vector div (Vector a, Vector b) { return _mm256_div_pd (a, b); }
+    static inline Vector sqrt (Vector v) { return _mm256_sqrt_pd (v); }
+    static inline Vector greaterThan (Vector a, Vector b) { return _mm256_cmp_pd (a, b, _CMP_GT_OQ); }
+    static inline Vector select (Vector mask, Vector a, Vector b) { return _mm256_blendv_pd (b, a, mask); }
+
+    static inline Vector reverse (Vector v)
+    {
+        Vector swappedHalves = _mm256_permute2f128_pd (v, v, 1);
+        return _mm256_permute_pd (swappedHalves, 5);
+    }
+
+    static inline void loadDeinterleaved (const double* p, Vector& even, Vector& odd)
+    {
+        Vector a = _mm256_loadu_pd (p);
+        Vector b = _mm256_loadu_pd (p + 4);
+        Vector low = _mm256_permute2f128_pd (a, b, 0x20);
+        Vector high = _mm256_permute2f128_pd (a, b, 0x31);
+        even = _mm256_unpacklo_pd (low, high);
+        odd = _mm256_unpackhi_pd (low, high);
+    }
+
+    static inline void storeInterleaved4 (double* p, Vector y0, Vector y1, Vector y2, Vector y3)
+    {
+        Vector t0 = _mm256_unpacklo_pd (y0, y1);
+        Vector t1 = _mm256_unpackhi_pd (y0, y1);
+        Vector t2 = _mm256_unpacklo_pd (y2, y3);
+        Vector t3 = _mm256_unpackhi_pd (y2, y3);
+        _mm256_storeu_pd (p, _mm256_permute2f128_pd (t0, t2, 0x20));
+        _mm256_storeu_pd (p + 4, _mm256_permute2f128_pd (t1, t3, 0x20));
+        _mm256_storeu_pd (p + 8, _mm256_permute2f128_pd (t0, t2, 0x31));
+        _mm256_storeu_pd (p + 12, _mm256_permute2f128_pd (t1, t3, 0x31));
+    }
+};
+#endif
+
+#if GIST_SIMD_AVX512
+//=======================================================================
+/** AVX-512 operations on 16 floats */
+struct AVX512FloatOperations
+{
+    typedef __m512 Vector;
+    static const int width = 16;
+
+    static inline Vector load (const float* p) { return _mm512_loadu_ps (p); }
+    static inline void store (float* p, Vector v) { _mm512_storeu_ps (p, v); }
+    static inline Vector set1 (float v) { return _mm512_set1_ps (v); }
+    static inline Vector add (Vector a, Vector b) { return _mm512_add_ps (a, b); }
+    static inline Vector sub (Vector a, Vector b) { return _mm512_sub_ps (a, b); }
+    static inline Vector mul (Vector a, Vector b) { return _mm512_mul_ps (a, b); }
+    static inline Vector max (Vector a, Vector b) { return _mm512_max_ps (a, b); }
+    static inline Vector div (Vector a, Vector b) { return _mm512_div_ps (a, b); }
+    static inline Vector sqrt (Vector v) { return _mm512_sqrt_ps (v); }
+
+    // comparisons give a mask register, which is widened to a vector of all-ones or zero lanes
+    static inline Vector greaterThan (Vector a, Vector b)
+    {
+        return _mm512_castsi512_ps (_mm512_maskz_set1_epi32 (_mm512_cmp_ps_mask (a, b, _CMP_GT_OQ), -1));
+    }
+
+    static inline Vector select (Vector mask, Vector a, Vector b)
+    {
+        __m512i maskBits = _mm512_castps_si512 (mask);
+        return _mm512_mask_blend_ps (_mm512_test_epi32_mask (maskBits, maskBits), b, a);
+    }
+};
+
+//=======================================================================
+/** AVX-512 operations on 8 doubles */
+struct AVX512DoubleOperations
+{
+    typedef __m512d Vector;
+    static const int width = 8;
+
+    static inline Vector load (const double* p) { return _mm512_loadu_pd (p); }
+    static inline void store (double* p, Vector v) { _mm512_storeu_pd (p, v); }
+    static inline Vector set1 (double v) { return _mm512_set1_pd (v); }
+    static inline Vector add (Vector a, Vector b) { return _mm512_add_pd (a, b); }
+    static inline Vector sub (Vector a, Vector b) { return _mm512_sub_pd (a, b); }
+    static inline Vector mul (Vector a, Vector b) { return _mm512_mul_pd (a, b); }
+    static inline Vector max (Vector a, Vector b) { return _mm512_max_pd (a, b); }
+    static inline Vector div (Vector a, Vector b) { return _mm512_div_pd (a, b); }
+    static inline Vector sqrt (Vector v) { return _mm512_sqrt_pd (v); }
+
+    static inline Vector greaterThan (Vector a, Vector b)
+    {
+        return _mm512_castsi512_pd (_mm512_maskz_set1_epi64 (_mm512_cmp_pd_mask (a, b, _CMP_GT_OQ), -1));
+    }
+
+    static inline Vector select (Vector mask, Vector a, Vector b)
+    {
+        __m512i maskBits = _mm512_castpd_si512 (mask);
+        return _mm512_mask_blend_pd (_mm512_test_epi64_mask (maskBits, maskBits), b, a);
+    }
+};
+#endif
+
+#if GIST_SIMD_NEON
+//=======================================================================
+/** NEON operations on 4 floats */
+struct NEONFloatOperations
+{
+    typedef float32x4_t Vector;
+    static const int width = 4;
+
+    static inline Vector load (const float* p) { return vld1q_f32 (p); }
+    static inline void store (float* p, Vector v) { vst1q_f32 (p, v); }
+    static inline Vector set1 (float v) { return vdupq_n_f32 (v); }
+    static inline Vector add (Vector a, Vector b) { return vaddq_f32 (a, b); }
+    static inline Vector sub (Vector a, Vector b) { return vsubq_f32 (a, b); }
+    static inline Vector mul (Vector a, Vector b) { return vmulq_f32 (a, b); }
+    static inline Vector max (Vector a, Vector b) { return vmaxq_f32 (a, b); }
+    static inline Vector greaterThan (Vector a, Vector b) { return vreinterpretq_f32_u32 (vcgtq_f32 (a, b)); }
+    static inline Vector select (Vector mask, Vector a, Vector b) { return vbslq_f32 (vreinterpretq_u32_f32 (mask), a, b); }
+
+#if defined (__aarch64__) || defined (_M_ARM64)
+    static inline Vector div (Vector a, Vector b) { return vdivq_f32 (a, b); }
+    static inline Vector sqrt (Vector v) { return vsqrtq_f32 (v); }
+#else
+    // 32-bit NEON has no vector division or square root, so these fall back to one lane at a time
+    static inline Vector div (Vector a, Vector b)
+    {
+        float x[4], y[4];
+        vst1q_f32 (x, a);
+        vst1q_f32 (y, b);
+        for (int i = 0; i < 4; i++) x[i] /= y[i];
+        return vld1q_f32 (x);
+    }
+
+    static inline Vector sqrt (Vector v)
+    {
+        float x[4];
+        vst1q_f32 (x, v);
+        for (int i = 0; i < 4; i++) x[i] = std::sqrt (x[i]);
+        return vld1q_f32 (x);
+    }
+#endif
+
+    static inline Vector reverse (Vector v)
+    {
+        Vector swappedPairs = vrev64q_f32 (v);
+        return vcombine_f32 (vget_high_f32 (swappedPairs), vget_low_f32 (swappedPairs));
+    }
+
+    static inline void loadDeinterleaved (const float* p, Vector& even, Vector& odd)
+    {
+        float32x4x2_t v = vld2q_f32 (p);
+        even = v.val[0];
+        odd = v.val[1];
+    }
+
+    static inline void storeInterleaved4 (float* p, Vector y0, Vector y1, Vector y2, Vector y3)
+    {
+        float32x4x4_t v;
+        v.val[0] = y0;
+        v.val[1] = y1;
+        v.val[2] = y2;
+        v.val[3] = y3;
+        vst4q_f32 (p, v);
+    }
+};
+
+#if defined (__aarch64__) || defined (_M_ARM64)
+//=======================================================================
+/** NEON operations on 2 doubles (AArch64 only) */
+struct NEONDoubleOperations
+{
+    typedef float64x2_t Vector;
+    static const int width = 2;
+
+    static inline Vector load (const double* p) { return vld1q_f64 (p); }
+    static inline void store (double* p, Vector v) { vst1q_f64 (p, v); }
+    static inline Vector set1 (double v) { return vdupq_n_f64 (v); }
+    static inline Vector add (Vector a, Vector b) { return vaddq_f64 (a, b); }
+    static inline Vector sub (Vector a, Vector b) { return vsubq_f64 (a, b); }
+    static inline Vector mul (Vector a, Vector b) { return vmulq_f64 (a, b); }
+    static inline Vector max (Vector a, Vector b) { return vmaxq_f64 (a, b); }
+    static inline Vector div (Vector a, Vector b) { return vdivq_f64 (a, b); }
+    static inline Vector sqrt (Vector v) { return vsqrtq_f64 (v); }
+    static inline Vector greaterThan (Vector a, Vector b) { return vreinterpretq_f64_u64 (vcgtq_f64 (a, b)); }
+    static inline Vector select (Vector mask, Vector a, Vector b) { return vbslq_f64 (vreinterpretq_u64_f64 (mask), a, b); }
+    static inline Vector reverse (Vector v) { return vextq_f64 (v, v, 1); }
+
+    static inline void loadDeinterleaved (const double* p, Vector& even, Vector& odd)
+    {
+        float64x2x2_t v = vld2q_f64 (p);
+        even = v.val[0];
+        odd = v.val[1];
+    }
+
+    static inline void storeInterleaved4 (double* p, Vector y0, Vector y1, Vector y2, Vector y3)
+    {
+        float64x2x4_t v;
+        v.val[0] = y0;
+        v.val[1] = y1;
+        v.val[2] = y2;
+        v.val[3] = y3;
+        vst4q_f64 (p, v);
+    }
+};
+#define GIST_SIMD_NEON_DOUBLE 1
+#endif
+#endif
+
+//=======================================================================
+/** The widest operations available at compile time for a sample type */
+template <class T>
+struct NativeOperations
+{
+    typedef ScalarOperations<T> Type;
+};
+
+#if GIST_SIMD_AVX
+template <> struct NativeOperations<float> { typedef AVXFloatOperations Type; };
+template <> struct NativeOperations<double> { typedef AVXDoubleOperations Type; };
+#elif GIST_SIMD_SSE2
+template <> struct NativeOperations<float> { typedef SSEFloatOperations Type; };
+template <> struct NativeOperations<double> { typedef SSEDoubleOperations Type; };
+#elif GIST_SIMD_NEON
+template <> struct NativeOperations<float> { typedef NEONFloatOperations Type; };
+#if GIST_SIMD_NEON_DOUBLE
+template <> struct NativeOperations<double> { typedef NEONDoubleOperations Type; };
+#endif
+#endif
+
+#ifdef GIST_SIMD_NAMESPACE
+}
+#endif
+
+#endif /* __SimdOperations__ */
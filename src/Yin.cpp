@@ -22,10 +22,27 @@
 //=======================================================================
 
 #include "Yin.h"
+#include "SimdKernels.h"
+#include <assert.h>
+#include <algorithm>
+#include <limits>
 
 //===========================================================
 template <class T>
 Yin<T>::Yin (int samplingFrequency)
+ :  maxPeriod (0),
+    threshold (0.1),
+    differenceMethod (DirectDifference),
+    earlyExit (true),
+    hopSize (0),
+    differenceSumsAreValid (false),
+    differenceSumsFrameSize (0),
+    numHopsSinceResync (0),
+    incrementalResyncInterval (64),
+    sharedFFTEngine (nullptr),
+    sharedFFTEngineFrameSize (0),
+    ownFFTEngineFrameSize (0),
+    decimationFactor (1)
 {
     fs = samplingFrequency;
     setMaxFrequency (1500);
@@ -39,6 +56,8 @@ void Yin<T>::setSamplingFrequency (int samplingFrequency)
     int oldFs = fs;
     fs = samplingFrequency;
     minPeriod = ((float) fs) / ((float) oldFs) * minPeriod;
+    maxPeriod = ((float) fs) / ((float) oldFs) * maxPeriod;
+    configureCoarseYin();
 }
 
 //===========================================================
@@ -54,18 +73,97 @@ void Yin<T>::setMaxFrequency (T maxFreq)
 
     minPeriodFloating = ((T) fs) / maxFreq;
     minPeriod = (int) ceil (minPeriodFloating);
+    configureCoarseYin();
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::setMinFrequency (T minFreq)
+{
+    // no lower limit, other than that set by the frame size
+    if (minFreq <= 0)
+    {
+        maxPeriod = 0;
+        configureCoarseYin();
+        return;
+    }
+    
+    maxPeriod = (int) ceil (((T) fs) / minFreq);
+    configureCoarseYin();
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::setEarlyExit (bool shouldExitEarly)
+{
+    earlyExit = shouldExitEarly;
+    configureCoarseYin();
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::setHopSize (int hopSize_)
+{
+    if (hopSize_ != hopSize)
+        resetIncrementalDifference();
+    
+    hopSize = hopSize_;
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::resetIncrementalDifference()
+{
+    differenceSumsAreValid = false;
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::setDecimationFactor (int factor)
+{
+    // the half-band cascade halves the rate at each stage
+    assert (factor == 1 || factor == 2 || factor == 4 || factor == 8);
+    
+    decimationFactor = factor;
+    configureCoarseYin();
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::setDifferenceMethod (YinDifferenceMethod method)
+{
+    differenceMethod = method;
+    configureCoarseYin();
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::setFFTEngine (FFTEngine<T>* engine, int frameSize)
+{
+    sharedFFTEngine = engine;
+    sharedFFTEngineFrameSize = frameSize;
 }
 
 //===========================================================
 template <class T>
 T Yin<T>::pitchYin (const std::vector<T>& frame)
 {
+    return pitchYin (frame.data(), frame.size());
+}
+
+//===========================================================
+template <class T>
+T Yin<T>::pitchYin (const T* frame, size_t numSamples)
+{
+    if (decimationFactor > 1)
+        return multiratePitchYin (frame, numSamples);
+    
     unsigned long period;
     T fPeriod;
     
     // steps 1, 2 and 3 of the Yin algorithm
     // get the difference function ("delta")
-    cumulativeMeanNormalisedDifferenceFunction (frame);
+    cumulativeMeanNormalisedDifferenceFunction (frame, numSamples);
     
     // first, see if the previous period estimate has a minima
     long continuityPeriod = searchForOtherRecentMinima (delta);
@@ -102,56 +200,322 @@ T Yin<T>::pitchYin (const std::vector<T>& frame)
 
 //===========================================================
 template <class T>
-void Yin<T>::cumulativeMeanNormalisedDifferenceFunction (const std::vector<T>& frame)
+void Yin<T>::cumulativeMeanNormalisedDifferenceFunction (const T* frame, size_t numSamples)
 {
     T cumulativeSum = 0.0;
-    unsigned long L = (unsigned long) frame.size() / 2;
+    unsigned long L = (unsigned long) numSamples / 2;
     
-    delta.resize(L);
+    // lags beyond the longest period searched for are not needed, except
+    // for one more to check for a minimum at the longest period itself
+    unsigned long numLags = L;
+    
+    if (maxPeriod > 0)
+        numLags = std::min (L, (unsigned long) maxPeriod + 2);
+    
+    delta.resize (numLags);
+    
+    if (numLags == 0)
+        return;
+    
+    if (differenceMethod == FFTDifference)
+        fftDifferenceFunction (frame, numSamples);
+    else if (differenceMethod == IncrementalDifference)
+        incrementalDifferenceFunction (frame, numSamples);
+    
+    // the lags searchForOtherRecentMinima() looks at around the previous period estimate
+    long continuityLags = (long) round (prevPeriodEstimate) + 3;
     
-    T *deltaPointer = &delta[0];
-
     // for each time lag tau
-    for (unsigned long tau = 0; tau < L; tau++)
+    for (unsigned long tau = 0; tau < numLags; tau++)
     {
-        *deltaPointer = 0.0;
-        
-        // sum all squared differences for all samples up to half way through
-        // the frame between the sample and the sample 'tau' samples away
-        for (unsigned long j = 0; j < L; j++)
-        {
-            T diff = frame[j] - frame[j + tau];
-            *deltaPointer += (diff * diff);
-        }
+        if (differenceMethod == DirectDifference)
+            delta[tau] = directDifference (frame, L, tau);
         
         // calculate the cumulative sum of tau values to date
         cumulativeSum = cumulativeSum + delta[tau];
         
         if (cumulativeSum > 0)
-            *deltaPointer = *deltaPointer * tau / cumulativeSum;
+            delta[tau] = delta[tau] * tau / cumulativeSum;
         
-        deltaPointer++;
+        // once there is a dip below the threshold, getPeriodCandidate() will choose it (or an
+        // earlier one), so with the continuity lags also done, the remaining lags are not needed
+        if (earlyExit && differenceMethod == DirectDifference && tau >= 3 && (long) tau >= continuityLags - 1)
+        {
+            unsigned long dip = tau - 1;
+            
+            if ((long) dip >= minPeriod && delta[dip] < threshold && delta[dip] < delta[dip - 1] && delta[dip] < delta[tau])
+            {
+                delta.resize (tau + 1);
+                break;
+            }
+        }
     }
     
     // set the first element to zero
     delta[0] = 1.;
 }
 
+//===========================================================
+template <class T>
+T Yin<T>::directDifference (const T* frame, unsigned long L, unsigned long tau)
+{
+    // sum all squared differences for all samples up to half way through
+    // the frame between the sample and the sample 'tau' samples away
+    return SimdKernels<T>::get().squaredDifferenceSum (frame, frame + tau, L);
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::fftDifferenceFunction (const T* frame, size_t numSamples)
+{
+    // the autocorrelation r(tau) = sum over j < L of x[j] x[j + tau] never reaches past
+    // the end of the frame for tau < L, so a circular correlation of the frame size is enough
+    int N = (int) numSamples;
+    int L = N / 2;
+    int numBins = N / 2 + 1;
+    
+    FFTEngine<T>* fftEngine = getFFTEngine (N);
+    
+    fftInput.resize (N);
+    frameReal.resize (numBins);
+    frameImag.resize (numBins);
+    windowReal.resize (numBins);
+    windowImag.resize (numBins);
+    
+    fftEngine->performFFT (frame, frameReal.data(), frameImag.data());
+    
+    std::copy (frame, frame + L, fftInput.begin());
+    std::fill (fftInput.begin() + L, fftInput.end(), (T)0);
+    fftEngine->performFFT (fftInput.data(), windowReal.data(), windowImag.data());
+    
+    // R = conj (W) F is Hermitian, so its inverse DFT is real and equals the forward DFT
+    // of the real sequence Re (R[k]) + Im (R[k]), taking the real plus the imaginary part
+    for (int k = 0; k < numBins; k++)
+    {
+        T real = windowReal[k] * frameReal[k] + windowImag[k] * frameImag[k];
+        T imag = windowReal[k] * frameImag[k] - windowImag[k] * frameReal[k];
+        
+        fftInput[k] = real + imag;
+        
+        if (k > 0 && k < N - k)
+            fftInput[N - k] = real - imag;
+    }
+    
+    fftEngine->performFFT (fftInput.data(), windowReal.data(), windowImag.data());
+    
+    // the energy of the first L samples, and of the L samples starting at tau
+    double energy = 0.0;
+    
+    for (int j = 0; j < L; j++)
+        energy += (double)frame[j] * (double)frame[j];
+    
+    double firstEnergy = energy;
+    double lagEnergy = energy;
+    T scale = (T)1.0 / (T)N;
+    
+    int numLags = (int) delta.size();
+    
+    for (int tau = 0; tau < numLags; tau++)
+    {
+        T autocorrelation = (windowReal[tau] + windowImag[tau]) * scale;
+        T energySum = (T)(firstEnergy + lagEnergy);
+        T difference = energySum - 2 * autocorrelation;
+        
+        // differences lost in the rounding error of the energies are taken to be zero
+        if (difference <= energySum * std::numeric_limits<T>::epsilon() * 64)
+            difference = 0;
+        
+        delta[tau] = difference;
+        
+        lagEnergy += (double)frame[tau + L] * (double)frame[tau + L] - (double)frame[tau] * (double)frame[tau];
+    }
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::incrementalDifferenceFunction (const T* frame, size_t numSamples)
+{
+    unsigned long L = (unsigned long) numSamples / 2;
+    unsigned long numLags = (unsigned long) delta.size();
+    unsigned long hop = (unsigned long) std::max (hopSize, 0);
+    
+    // the terms the next hop removes reach hopSize + numLags samples into the frame
+    unsigned long numSamplesToKeep = std::min ((unsigned long) numSamples, hop + numLags);
+    
+    bool canUpdate = differenceSumsAreValid
+                     && hop > 0 && hop < L
+                     && differenceSumsFrameSize == numSamples
+                     && differenceSums.size() == numLags
+                     && previousFrame.size() == numSamplesToKeep
+                     && numHopsSinceResync < incrementalResyncInterval;
+    
+    differenceSums.resize (numLags);
+    
+    if (canUpdate)
+    {
+        const SimdKernels<T>& kernels = SimdKernels<T>::get();
+        
+        // the inner loop runs over the lags, so that it reads contiguous samples and vectorises
+        for (unsigned long j = 0; j < hop; j++)
+        {
+            // remove the term for a sample the frame has moved past, and add the term for a sample it has moved on to
+            const T* oldSamples = previousFrame.data() + j;
+            const T* newSamples = frame + (L - hop) + j;
+            
+            kernels.slideDifferenceSums (differenceSums.data(), oldSamples, newSamples, numLags);
+        }
+        
+        numHopsSinceResync++;
+    }
+    else
+    {
+        for (unsigned long tau = 0; tau < numLags; tau++)
+            differenceSums[tau] = directDifference (frame, L, tau);
+        
+        numHopsSinceResync = 0;
+    }
+    
+    previousFrame.assign (frame, frame + numSamplesToKeep);
+    differenceSumsFrameSize = numSamples;
+    differenceSumsAreValid = true;
+    
+    // sums of squares can only come out negative through rounding
+    for (unsigned long tau = 0; tau < numLags; tau++)
+        delta[tau] = std::max (differenceSums[tau], (T)0);
+}
+
+//===========================================================
+template <class T>
+T Yin<T>::multiratePitchYin (const T* frame, size_t numSamples)
+{
+    long L = (long) numSamples / 2;
+    long D = decimationFactor;
+    
+    decimate (frame, numSamples);
+    
+    // the period at full rate, to within the decimation factor
+    T coarsePitch = coarseYin->pitchYin (decimatedFrame.data(), decimatedFrame.size());
+    long coarsePeriod = (long) round (D * ((T) coarseYin->fs) / coarsePitch);
+    
+    // the lags to search, and one either side of them for the interpolation
+    long firstLag = std::max (coarsePeriod - D, std::max ((long) minPeriod, 1L));
+    long lastLag = std::min (coarsePeriod + D, L - 2);
+    
+    if (maxPeriod > 0)
+        lastLag = std::min (lastLag, (long) maxPeriod);
+    
+    if (firstLag > lastLag)
+    {
+        prevPeriodEstimate = (T) std::max (coarsePeriod, 1L);
+        return periodToPitch (prevPeriodEstimate);
+    }
+    
+    // over a few lags the cumulative sum changes little, so the normalised difference
+    // function is in proportion to d(tau) * tau, which locates and interpolates the minimum
+    refinedDifferences.resize (lastLag - firstLag + 3);
+    
+    for (long tau = firstLag - 1; tau <= lastLag + 1; tau++)
+        refinedDifferences[tau - firstLag + 1] = directDifference (frame, (unsigned long) L, (unsigned long) tau) * tau;
+    
+    long period = std::min (std::max (coarsePeriod, firstLag), lastLag);
+    
+    for (long tau = firstLag; tau <= lastLag; tau++)
+    {
+        if (refinedDifferences[tau - firstLag + 1] < refinedDifferences[period - firstLag + 1])
+            period = tau;
+    }
+    
+    const T* y = &refinedDifferences[period - firstLag + 1];
+    prevPeriodEstimate = parabolicInterpolation ((unsigned long) period, y[-1], y[0], y[1]);
+    
+    return periodToPitch (prevPeriodEstimate);
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::decimate (const T* frame, size_t numSamples)
+{
+    const T* input = frame;
+    long numInputSamples = (long) numSamples;
+    
+    int stage = 0;
+    
+    for (int factor = decimationFactor; factor > 1; factor /= 2)
+    {
+        // the last stage writes to the decimated frame, the others alternate between two buffers
+        std::vector<T>& output = (factor == 2) ? decimatedFrame : decimationBuffers[stage % 2];
+        long numOutputSamples = numInputSamples / 2;
+        
+        output.resize (numOutputSamples);
+        
+        T* out = output.data();
+        
+        // 7 tap half-band filter, (-1, 0, 9, 16, 9, 0, -1) / 32, repeating the edge samples
+        for (long i = 0; i < numOutputSamples; i++)
+        {
+            long j = 2 * i;
+            T xm3 = input[std::max (j - 3, 0L)];
+            T xm1 = input[std::max (j - 1, 0L)];
+            T xp1 = input[std::min (j + 1, numInputSamples - 1)];
+            T xp3 = input[std::min (j + 3, numInputSamples - 1)];
+            
+            out[i] = ((T)16 * input[j] + (T)9 * (xm1 + xp1) - (xm3 + xp3)) * (T)(1.0 / 32.0);
+        }
+        
+        input = out;
+        numInputSamples = numOutputSamples;
+        stage++;
+    }
+}
+
+//===========================================================
+template <class T>
+void Yin<T>::configureCoarseYin()
+{
+    if (decimationFactor <= 1)
+    {
+        coarseYin.reset();
+        return;
+    }
+    
+    coarseYin.reset (new Yin<T> (fs / decimationFactor));
+    coarseYin->setMaxFrequency (getMaxFrequency());
+    coarseYin->setMinFrequency (getMinFrequency());
+    coarseYin->setEarlyExit (earlyExit);
+    
+    // the coarse frames are too short for the incremental sums to pay off
+    coarseYin->setDifferenceMethod (differenceMethod == FFTDifference ? FFTDifference : DirectDifference);
+}
+
+//===========================================================
+template <class T>
+FFTEngine<T>* Yin<T>::getFFTEngine (int frameSize)
+{
+    if (sharedFFTEngine != nullptr && sharedFFTEngineFrameSize == frameSize)
+        return sharedFFTEngine;
+    
+    if (ownFFTEngine == nullptr || ownFFTEngineFrameSize != frameSize)
+    {
+        ownFFTEngine = FFTEngine<T>::create (FFTEngine<T>::resolveBackend (DefaultFFTBackend, frameSize));
+        ownFFTEngine->setAudioFrameSize (frameSize);
+        ownFFTEngineFrameSize = frameSize;
+    }
+    
+    return ownFFTEngine.get();
+}
+
 //===========================================================
 template <class T>
 unsigned long Yin<T>::getPeriodCandidate (const std::vector<T>& delta)
 {
-    unsigned long minPeriod = 30;
     unsigned long period;
     
-    T thresh = 0.1;
-    
     bool periodCandidateFound = false;
     
     T minVal = 100000;
     unsigned long minInd = 0;
     
-    for (unsigned long i = minPeriod; i < (delta.size() - 1); i++)
+    for (unsigned long i = (unsigned long) minPeriod; i < (delta.size() - 1); i++)
     {
         if (delta[i] < minVal)
         {
@@ -159,7 +523,7 @@ unsigned long Yin<T>::getPeriodCandidate (const std::vector<T>& delta)
             minInd = i;
         }
         
-        if (delta[i] < thresh)
+        if (delta[i] < threshold)
         {
             if ((delta[i] < delta[i-1]) && (delta[i] < delta[i+1]))
             {
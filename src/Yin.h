@@ -26,6 +26,18 @@
 
 #include <vector>
 #include <cmath>
+#include <memory>
+#include <stddef.h>
+#include "FFTEngine.h"
+
+//===========================================================
+/** The ways Yin can calculate its difference function */
+enum YinDifferenceMethod
+{
+    DirectDifference,       /**< sums the squared differences for every lag, O(N^2) */
+    FFTDifference,          /**< derives the difference function from the autocorrelation, calculated with the FFT, O(N log N) */
+    IncrementalDifference /**< updates running sums for each lag from the previous frame, O(N x hop size), for successive overlapping frames */
+};
 
 //===========================================================
 /** template class for the pitch detection algorithm Yin.
@@ -54,7 +66,71 @@ public:
      */
     void setMaxFrequency (T maxFreq);
     
+    /** sets the minimum frequency that the algorithm will search for. Lags longer than the
+     * corresponding period are not calculated, which saves time when the lowest pitch of
+     * interest is well above the lowest one the frame size allows
+     * @param minFreq the minimum frequency, or 0 to search as low as the frame size allows
+     */
+    void setMinFrequency (T minFreq);
+    
+    /** sets whether the direct difference function stops at the first dip below the absolute
+     * threshold, once it (and the lags around the previous period estimate) have been calculated.
+     * The estimate is the same either way, since the first such dip is the one chosen. On by default
+     * @param shouldExitEarly true to stop at the first dip, false to always calculate every lag
+     */
+    void setEarlyExit (bool shouldExitEarly);
+    
+    /** sets the number of samples between the starts of successive frames. The incremental
+     * difference method relies on each frame starting this many samples after the last one
+     * @param hopSize the hop size in samples
+     */
+    void setHopSize (int hopSize);
+    
+    /** tells the incremental difference method that the next frame does not follow on from
+     * the last one (e.g. after a seek), so its running sums are calculated afresh */
+    void resetIncrementalDifference();
+    
+    /** sets up coarse-to-fine estimation. With a factor above 1, the frame is low pass filtered
+     * and decimated by the factor, Yin finds the period of the shorter frame, and then the
+     * difference function is only calculated at full rate for the lags around that period.
+     * This costs roughly 1 / factor^2 of a full calculation, and is accurate for pitches well
+     * below the reduced Nyquist frequency, (fs / factor) / 2
+     * @param factor 1 (off), 2, 4 or 8
+     */
+    void setDecimationFactor (int factor);
+    
+    /** sets how the difference function is calculated. The FFT method is much faster for
+     * all but the smallest frames, and matches the direct method to within rounding error
+     * @param method the difference function method to use
+     */
+    void setDifferenceMethod (YinDifferenceMethod method);
+    
+    /** shares an FFT engine with the algorithm, which it uses for frames of the size the engine
+     * is set up for when the FFT difference method is in use. Otherwise Yin creates its own engine
+     * @param engine an FFT engine, which must outlive its use here, or nullptr to stop sharing
+     * @param frameSize the frame size the engine has been set up for
+     */
+    void setFFTEngine (FFTEngine<T>* engine, int frameSize);
+    
     //===========================================================
+    /** @returns the method used to calculate the difference function */
+    YinDifferenceMethod getDifferenceMethod()
+    {
+        return differenceMethod;
+    }
+    
+    /** @returns the factor frames are decimated by for coarse-to-fine estimation, or 1 if not used */
+    int getDecimationFactor()
+    {
+        return decimationFactor;
+    }
+    
+    /** @returns the minimum frequency that the algorithm will search for, or 0 if only limited by the frame size */
+    T getMinFrequency()
+    {
+        return maxPeriod > 0 ? ((T) fs) / ((T) maxPeriod) : 0;
+    }
+    
     /** @returns the maximum frequency that the algorithm will return */
     T getMaxFrequency()
     {
@@ -67,6 +143,13 @@ public:
      * @returns the estimated pitch in Hz
      */
     T pitchYin (const std::vector<T>& frame);
+
+    /** calculates the pitch of the audio frame passed to it
+     * @param frame a pointer to the audio samples
+     * @param numSamples the number of samples in the frame
+     * @returns the estimated pitch in Hz
+     */
+    T pitchYin (const T* frame, size_t numSamples);
         
 private:
     
@@ -102,9 +185,55 @@ private:
     
     /** this calculates steps 1, 2 and 3 of the Yin algorithm as set out in
      * the paper (de Cheveigné and Kawahara,2002).
-     * @param frame a vector containing the audio frame to be procesed
+     * @param frame a pointer to the audio frame to be procesed
+     * @param numSamples the number of samples in the frame
      */
-    void cumulativeMeanNormalisedDifferenceFunction (const std::vector<T>& frame);
+    void cumulativeMeanNormalisedDifferenceFunction (const T* frame, size_t numSamples);
+    
+    /** calculates one lag of the difference function by summing squared differences
+     * @param frame a pointer to the audio frame to be procesed
+     * @param L the number of samples summed over (half the frame size)
+     * @param tau the lag
+     * @returns the difference function at lag tau
+     */
+    T directDifference (const T* frame, unsigned long L, unsigned long tau);
+    
+    /** calculates every lag of delta (as sized by the caller) as E(0) + E(tau) - 2 r(tau), from
+     * the autocorrelation r (calculated with the FFT) and windowed energies E
+     * @param frame a pointer to the audio frame to be procesed
+     * @param numSamples the number of samples in the frame
+     */
+    void fftDifferenceFunction (const T* frame, size_t numSamples);
+    
+    /** calculates every lag of delta (as sized by the caller) by updating the running sums of
+     * squared differences: the terms the hop moved past are subtracted, using the previous
+     * frame, and the new terms are added. The sums are recalculated in full for the first frame,
+     * after any change of frame size or lags, and every incrementalResyncInterval hops to stop
+     * rounding errors building up
+     * @param frame a pointer to the audio frame to be procesed
+     * @param numSamples the number of samples in the frame
+     */
+    void incrementalDifferenceFunction (const T* frame, size_t numSamples);
+    
+    /** @returns an FFT engine set up for the frame size: the shared one if it fits, otherwise Yin's own */
+    FFTEngine<T>* getFFTEngine (int frameSize);
+    
+    /** estimates the pitch coarse-to-fine: Yin on the decimated frame, then refinement at full rate
+     * @param frame a pointer to the audio frame to be procesed
+     * @param numSamples the number of samples in the frame
+     * @returns the estimated pitch in Hz
+     */
+    T multiratePitchYin (const T* frame, size_t numSamples);
+    
+    /** low pass filters and decimates a frame by decimationFactor into decimatedFrame, with a
+     * cascade of half-band filters that each halve the sample rate
+     * @param frame a pointer to the audio frame to be procesed
+     * @param numSamples the number of samples in the frame
+     */
+    void decimate (const T* frame, size_t numSamples);
+    
+    /** recreates the Yin object used on decimated frames, after the settings it copies have changed */
+    void configureCoarseYin();
     
 	T round (T val)
 	{
@@ -120,7 +249,42 @@ private:
     /** the minimum period the algorithm will look for. this is set indirectly by setMaxFrequency() */
     int minPeriod;
     
+    /** the maximum period the algorithm will look for, or 0 for no limit. this is set indirectly by setMinFrequency() */
+    int maxPeriod;
+    
+    /** the absolute threshold a dip in the cumulative mean normalised difference function must fall below */
+    T threshold;
+    
     std::vector<T> delta;
+    
+    /** the method used to calculate the difference function */
+    YinDifferenceMethod differenceMethod;
+    
+    /** true if the direct difference function stops at the first dip below the threshold */
+    bool earlyExit;
+    
+    int hopSize;                                     /**< the number of samples between the starts of successive frames */
+    std::vector<T> differenceSums;                   /**< the running difference function sums of the incremental method */
+    std::vector<T> previousFrame;                    /**< the start of the previous frame, holding the terms the next hop removes */
+    bool differenceSumsAreValid;                     /**< true if differenceSums hold the sums for the previous frame */
+    size_t differenceSumsFrameSize;                  /**< the frame size differenceSums were calculated for */
+    int numHopsSinceResync;                          /**< the number of updates since differenceSums were last recalculated in full */
+    int incrementalResyncInterval;                   /**< the number of updates after which differenceSums are recalculated in full */
+    
+    FFTEngine<T>* sharedFFTEngine;                   /**< an engine shared by the owner, e.g. Gist, or nullptr */
+    int sharedFFTEngineFrameSize;                    /**< the frame size the shared engine is set up for */
+    std::unique_ptr<FFTEngine<T>> ownFFTEngine;      /**< the engine used when the shared one doesn't fit the frame */
+    int ownFFTEngineFrameSize;                       /**< the frame size the own engine is set up for */
+    
+    std::vector<T> fftInput;                         /**< the time domain input to each FFT */
+    std::vector<T> frameReal, frameImag;             /**< the spectrum of the frame */
+    std::vector<T> windowReal, windowImag;           /**< the spectrum of the first half of the frame */
+    
+    int decimationFactor;                            /**< the factor frames are decimated by for coarse-to-fine estimation */
+    std::unique_ptr<Yin<T>> coarseYin;               /**< estimates the period of decimated frames */
+    std::vector<T> decimatedFrame;                   /**< the decimated frame */
+    std::vector<T> decimationBuffers[2];             /**< the outputs of intermediate half-band stages */
+    std::vector<T> refinedDifferences;               /**< the full rate difference function around the coarse period */
 };
 
 #endif
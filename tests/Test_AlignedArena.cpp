@@ -0,0 +1,66 @@
+#include "doctest.h"
+#include <AlignedArena.h>
+#include <stdint.h>
+
+//=============================================================
+//======================= ALIGNED ARENA =======================
+//=============================================================
+TEST_SUITE ("AlignedArena")
+{
+    // ------------------------------------------------------------
+    // 1. Check that every buffer starts on a 64 byte boundary, follows the previous one, and starts as zeros
+    TEST_CASE ("Layout_Test")
+    {
+        AlignedArena<float> arena;
+
+        const size_t sizes[] = {1, 17, 16, 513, 3};
+        size_t offsets[5];
+
+        for (int i = 0; i < 5; i++)
+            offsets[i] = arena.addBuffer (sizes[i]);
+
+        arena.allocate();
+
+        for (int i = 0; i < 5; i++)
+        {
+            float* buffer = arena.getBuffer (offsets[i]);
+
+            CHECK_EQ (reinterpret_cast<uintptr_t> (buffer) % AlignedArena<float>::alignment, 0);
+
+            if (i > 0)
+                CHECK (buffer >= arena.getBuffer (offsets[i - 1]) + sizes[i - 1]);
+
+            for (size_t j = 0; j < sizes[i]; j++)
+                CHECK_EQ (buffer[j], 0.f);
+        }
+
+        CHECK (arena.getSize() >= offsets[4] + sizes[4]);
+    }
+
+    // ------------------------------------------------------------
+    // 2. Check that laying the buffers out again clears them, and keeps memory that is big enough
+    TEST_CASE ("Reallocate_Test")
+    {
+        AlignedArena<double> arena;
+
+        size_t offset = arena.addBuffer (1024);
+        arena.allocate();
+
+        double* buffer = arena.getBuffer (offset);
+        buffer[10] = 1.0;
+
+        arena.clear();
+        offset = arena.addBuffer (512);
+        arena.allocate();
+
+        CHECK_EQ (arena.getBuffer (offset), buffer);
+        CHECK_EQ (arena.getBuffer (offset)[10], 0.0);
+
+        arena.clear();
+        offset = arena.addBuffer (4096);
+        arena.allocate();
+
+        CHECK_EQ (reinterpret_cast<uintptr_t> (arena.getBuffer (offset)) % AlignedArena<double>::alignment, 0);
+        CHECK_EQ (arena.getBuffer (offset)[4095], 0.0);
+    }
+}
@@ -367,3 +367,69 @@ TEST_SUITE ("SpectralKurtosis")
         CHECK (r == doctest::Approx (4.95919732441).epsilon (0.000001));
     }
 }
+
+//=============================================================
+//=================== SPECTRAL STATISTICS =====================
+//=============================================================
+TEST_SUITE ("SpectralStatistics")
+{
+    // ------------------------------------------------------------
+    // 1. Check that the fused statistics match the individual functions
+    TEST_CASE ("MatchesIndividualFunctionsTest")
+    {
+        CoreFrequencyDomainFeatures<double> fdf;
+        
+        // include sizes that are not a multiple of the block size
+        const int sizes[] = {1, 7, 64, 257, 512, 1023};
+        
+        for (int size : sizes)
+        {
+            std::vector<double> testSpectrum (size);
+            
+            for (int i = 0; i < size; i++)
+                testSpectrum[i] = ((double)(rand() % 1000)) / 10.;
+            
+            CoreFrequencyDomainFeatures<double>::Statistics statistics = fdf.calculateStatistics (testSpectrum);
+            
+            CHECK (statistics.spectralCentroid == doctest::Approx (fdf.spectralCentroid (testSpectrum)));
+            CHECK (statistics.spectralCrest == doctest::Approx (fdf.spectralCrest (testSpectrum)));
+            CHECK (statistics.spectralFlatness == doctest::Approx (fdf.spectralFlatness (testSpectrum)));
+            CHECK (statistics.spectralRolloff == doctest::Approx (fdf.spectralRolloff (testSpectrum)));
+            CHECK (statistics.spectralKurtosis == doctest::Approx (fdf.spectralKurtosis (testSpectrum)));
+        }
+    }
+    
+    // ------------------------------------------------------------
+    // 2. Check the edge cases shared with the individual functions
+    TEST_CASE ("ZerosAndOnesTest")
+    {
+        CoreFrequencyDomainFeatures<float> fdf;
+        
+        std::vector<float> zeros (512, 0.f);
+        CoreFrequencyDomainFeatures<float>::Statistics statistics = fdf.calculateStatistics (zeros);
+        
+        CHECK_EQ (statistics.spectralCentroid, 0.f);
+        CHECK_EQ (statistics.spectralCrest, 1.f);
+        CHECK_EQ (statistics.spectralFlatness, 1.f);
+        CHECK_EQ (statistics.spectralRolloff, 0.f);
+        CHECK_EQ (statistics.spectralKurtosis, -3.f);
+        
+        std::vector<float> ones (512, 1.f);
+        statistics = fdf.calculateStatistics (ones, 0.85f);
+        
+        CHECK_EQ (statistics.spectralRolloff, roundf (0.85 * 512.) / 512.);
+        CHECK_EQ (statistics.spectralKurtosis, -3.f);
+    }
+    
+    // ------------------------------------------------------------
+    // 3. Check that the rolloff does not truncate fractional magnitudes
+    TEST_CASE ("FractionalRolloffTest")
+    {
+        CoreFrequencyDomainFeatures<float> fdf;
+        
+        std::vector<float> testSpectrum (100, 0.5f);
+        
+        CHECK_EQ (fdf.spectralRolloff (testSpectrum, 0.5f), 50.f / 100.f);
+        CHECK_EQ (fdf.calculateStatistics (testSpectrum, 0.5f).spectralRolloff, 50.f / 100.f);
+    }
+}
@@ -1,5 +1,6 @@
 #include "doctest.h"
 #include <Gist.h>
+#include <algorithm>
 
 //=============================================================
 //========================= RMS ===============================
@@ -206,3 +207,45 @@ TEST_SUITE ("ZeroCrossingRate")
         CHECK_EQ (r, 3);
     }
 }
+
+//=============================================================
+//======================== STATISTICS =========================
+//=============================================================
+TEST_SUITE ("TimeDomainStatistics")
+{
+    // ------------------------------------------------------------
+    // 1. Check the vectorised pass against a plain loop, for sizes that are not
+    // a multiple of the vector width and for frames containing exact zeros
+    TEST_CASE ("MatchesScalarLoopTest")
+    {
+        CoreTimeDomainFeatures<double> tdf;
+        
+        const int sizes[] = {1, 2, 7, 64, 513, 1024};
+        
+        for (int size : sizes)
+        {
+            std::vector<double> buffer (size);
+            
+            for (int i = 0; i < size; i++)
+                buffer[i] = i % 9 == 4 ? 0. : ((double)((rand() % 1000) - 500)) / 1000.;
+            
+            double energy = 0, peak = 0, zcr = 0;
+            
+            for (int i = 0; i < size; i++)
+            {
+                energy += buffer[i] * buffer[i];
+                peak = std::max (peak, fabs (buffer[i]));
+                
+                if (i > 0 && (buffer[i] > 0) != (buffer[i - 1] > 0))
+                    zcr += 1;
+            }
+            
+            CoreTimeDomainFeatures<double>::Statistics statistics = tdf.calculateStatistics (buffer);
+            
+            CHECK (statistics.energy == doctest::Approx (energy));
+            CHECK (statistics.rootMeanSquare == doctest::Approx (sqrt (energy / size)));
+            CHECK_EQ (statistics.peakEnergy, peak);
+            CHECK_EQ (statistics.zeroCrossingRate, zcr);
+        }
+    }
+}
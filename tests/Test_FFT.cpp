@@ -0,0 +1,285 @@
+#include "doctest.h"
+#include <Gist.h>
+#include <KissFFT.h>
+#include <SimdFFT.h>
+#include <cmath>
+#include <thread>
+
+//=============================================================
+//====================== FFT PLAN CACHE =======================
+//=============================================================
+TEST_SUITE ("FFTPlanCache")
+{
+    // ------------------------------------------------------------
+    // 1. Check that the same key returns the same plan while it is alive
+    TEST_CASE ("SharedPlanTest")
+    {
+        int numCreated = 0;
+        int numDestroyed = 0;
+        
+        FFTPlanCache::PlanKey key (KissFFTBackend, 12345, 3, ForwardFFT);
+        
+        auto createPlan = [&numCreated]() { numCreated++; return new int (7); };
+        auto destroyPlan = [&numDestroyed] (int* plan) { numDestroyed++; delete plan; };
+        
+        {
+            std::shared_ptr<int> plan1 = FFTPlanCache::getPlan<int> (key, createPlan, destroyPlan);
+            std::shared_ptr<int> plan2 = FFTPlanCache::getPlan<int> (key, createPlan, destroyPlan);
+            
+            CHECK_EQ (plan1.get(), plan2.get());
+            CHECK_EQ (numCreated, 1);
+            CHECK_EQ (numDestroyed, 0);
+        }
+        
+        // the plan is destroyed when the last user releases it
+        CHECK_EQ (numDestroyed, 1);
+        
+        std::shared_ptr<int> plan3 = FFTPlanCache::getPlan<int> (key, createPlan, destroyPlan);
+        CHECK_EQ (numCreated, 2);
+    }
+    
+    // ------------------------------------------------------------
+    // 2. Check that keys differing in any field get different plans
+    TEST_CASE ("DifferentKeysTest")
+    {
+        auto createPlan = []() { return new int (0); };
+        auto destroyPlan = [] (int* plan) { delete plan; };
+        
+        std::shared_ptr<int> plan1 = FFTPlanCache::getPlan<int> (FFTPlanCache::PlanKey (KissFFTBackend, 777, 4, ForwardFFT), createPlan, destroyPlan);
+        std::shared_ptr<int> plan2 = FFTPlanCache::getPlan<int> (FFTPlanCache::PlanKey (KissFFTBackend, 777, 8, ForwardFFT), createPlan, destroyPlan);
+        std::shared_ptr<int> plan3 = FFTPlanCache::getPlan<int> (FFTPlanCache::PlanKey (KissFFTBackend, 777, 4, InverseFFT), createPlan, destroyPlan);
+        std::shared_ptr<int> plan4 = FFTPlanCache::getPlan<int> (FFTPlanCache::PlanKey (KissFFTBackend, 778, 4, ForwardFFT), createPlan, destroyPlan);
+        
+        CHECK (plan1 != plan2);
+        CHECK (plan1 != plan3);
+        CHECK (plan1 != plan4);
+    }
+    
+    // ------------------------------------------------------------
+    // 3. Check that Gist objects of the same size share a plan
+    TEST_CASE ("GistSharesPlansTest")
+    {
+        size_t numPlansBefore = FFTPlanCache::getNumPlans();
+        
+        Gist<float> g1 (1000, 44100);
+        size_t numPlansAfterFirst = FFTPlanCache::getNumPlans();
+        
+        Gist<float> g2 (1000, 44100);
+        CHECK_EQ (FFTPlanCache::getNumPlans(), numPlansAfterFirst);
+        CHECK (numPlansAfterFirst > numPlansBefore);
+    }
+    
+    // ------------------------------------------------------------
+    // 4. Check that Gist objects can be created and used concurrently
+    TEST_CASE ("ConcurrentConstructionTest")
+    {
+        const int numThreads = 8;
+        const int frameSize = 1024;
+        
+        std::vector<float> frame (frameSize);
+        
+        for (int i = 0; i < frameSize; i++)
+            frame[i] = ((float)((rand() % 1000) - 500)) / 1000.f;
+        
+        Gist<float> reference (frameSize, 44100);
+        reference.processAudioFrame (frame);
+        std::vector<float> expected = reference.getMagnitudeSpectrum();
+        
+        std::vector<int> numMismatches (numThreads, 0);
+        std::vector<std::thread> threads;
+        
+        for (int t = 0; t < numThreads; t++)
+        {
+            threads.emplace_back ([t, &frame, &expected, &numMismatches]()
+            {
+                for (int iteration = 0; iteration < 20; iteration++)
+                {
+                    Gist<float> g (frameSize, 44100);
+                    g.processAudioFrame (frame);
+                    
+                    if (g.getMagnitudeSpectrum() != expected)
+                        numMismatches[t]++;
+                }
+            });
+        }
+        
+        for (auto& thread : threads)
+            thread.join();
+        
+        for (int t = 0; t < numThreads; t++)
+            CHECK_EQ (numMismatches[t], 0);
+    }
+}
+
+//=============================================================
+//========================= SIMD FFT ==========================
+//=============================================================
+/** Checks SimdFFT against a direct DFT calculated in long double, to within tolerance * frameSize */
+template <class T>
+static void checkSimdFFTMatchesDFT (T tolerance)
+{
+    for (int frameSize = 2; frameSize <= 4096; frameSize *= 2)
+    {
+        INFO ("frame size " << frameSize);
+        
+        std::vector<T> frame (frameSize);
+        
+        for (int i = 0; i < frameSize; i++)
+            frame[i] = ((T)((rand() % 1000) - 500)) / (T)1000;
+        
+        std::vector<T> real (frameSize / 2 + 1);
+        std::vector<T> imag (frameSize / 2 + 1);
+        
+        SimdFFT<T> fft;
+        fft.setAudioFrameSize (frameSize);
+        fft.performFFT (frame.data(), real.data(), imag.data());
+        
+        const T maxError = tolerance * frameSize;
+        const long double pi = acosl (-1.L);
+        
+        for (int k = 0; k <= frameSize / 2; k++)
+        {
+            long double expectedReal = 0;
+            long double expectedImag = 0;
+            
+            for (int n = 0; n < frameSize; n++)
+            {
+                // reducing k * n keeps the angle small, so the twiddles are accurate to long double precision
+                const long double angle = 2.L * pi * ((k * n) % frameSize) / frameSize;
+                expectedReal += frame[n] * cosl (angle);
+                expectedImag -= frame[n] * sinl (angle);
+            }
+            
+            CHECK (std::abs ((long double) real[k] - expectedReal) <= maxError);
+            CHECK (std::abs ((long double) imag[k] - expectedImag) <= maxError);
+        }
+    }
+}
+
+//=============================================================
+TEST_SUITE ("SimdFFT")
+{
+    // ------------------------------------------------------------
+    // 1. Check the output against a direct DFT for every power of two up to 4096
+    TEST_CASE ("MatchesDFTTest")
+    {
+        checkSimdFFTMatchesDFT<double> (1e-9);
+        checkSimdFFTMatchesDFT<float> (1e-4f);
+    }
+    
+    // ------------------------------------------------------------
+    // 2. Check that the single precision transform agrees with Kiss FFT
+    TEST_CASE ("MatchesKissFFTTest")
+    {
+        for (int frameSize = 16; frameSize <= 4096; frameSize *= 2)
+        {
+            std::vector<float> frame (frameSize);
+            
+            for (int i = 0; i < frameSize; i++)
+                frame[i] = ((float)((rand() % 1000) - 500)) / 1000.f;
+            
+            std::vector<float> simdReal (frameSize / 2 + 1), simdImag (frameSize / 2 + 1);
+            std::vector<float> kissReal (frameSize / 2 + 1), kissImag (frameSize / 2 + 1);
+            
+            SimdFFT<float> simdFFT;
+            simdFFT.setAudioFrameSize (frameSize);
+            simdFFT.performFFT (frame.data(), simdReal.data(), simdImag.data());
+            
+            KissFFT<float> kissFFT;
+            kissFFT.setAudioFrameSize (frameSize);
+            kissFFT.performFFT (frame.data(), kissReal.data(), kissImag.data());
+            
+            for (int k = 0; k <= frameSize / 2; k++)
+            {
+                CHECK (simdReal[k] == doctest::Approx (kissReal[k]).epsilon (0.001).scale (frameSize));
+                CHECK (simdImag[k] == doctest::Approx (kissImag[k]).epsilon (0.001).scale (frameSize));
+            }
+        }
+    }
+    
+    // ------------------------------------------------------------
+    // 3. Check the supported frame sizes
+    TEST_CASE ("SupportedFrameSizesTest")
+    {
+        CHECK (SimdFFT<float>::isFrameSizeSupported (256));
+        CHECK (SimdFFT<float>::isFrameSizeSupported (2048));
+        CHECK_FALSE (SimdFFT<float>::isFrameSizeSupported (1000));
+        CHECK_FALSE (SimdFFT<float>::isFrameSizeSupported (1));
+        CHECK_FALSE (SimdFFT<float>::isFrameSizeSupported (0));
+    }
+}
+
+//=============================================================
+//======================== FFT ENGINE =========================
+//=============================================================
+TEST_SUITE ("FFTEngine")
+{
+    // ------------------------------------------------------------
+    // 1. Check that every available backend produces the same spectrum through Gist
+    TEST_CASE ("BackendsAgreeTest")
+    {
+        const FFTBackend backends[] = {KissFFTBackend, SimdFFTBackend, FFTWBackend, AccelerateFFTBackend};
+        const int frameSizes[] = {1024, 1000};
+        
+        for (int frameSize : frameSizes)
+        {
+            std::vector<double> frame (frameSize);
+            
+            for (int i = 0; i < frameSize; i++)
+                frame[i] = ((double)((rand() % 1000) - 500)) / 1000.;
+            
+            Gist<double> reference (frameSize, 44100, HanningWindow, KissFFTBackend);
+            reference.processAudioFrame (frame);
+            
+            for (FFTBackend backend : backends)
+            {
+                if (! FFTEngine<double>::isBackendAvailable (backend, frameSize))
+                    continue;
+                
+                Gist<double> g (frameSize, 44100, HanningWindow, backend);
+                CHECK_EQ (g.getFFTBackend(), backend);
+                
+                g.processAudioFrame (frame);
+                
+                for (int i = 0; i < frameSize / 2; i++)
+                    CHECK (g.getMagnitudeSpectrum()[i] == doctest::Approx (reference.getMagnitudeSpectrum()[i]).epsilon (0.0001).scale (1.));
+            }
+        }
+    }
+    
+    // ------------------------------------------------------------
+    // 2. Check the resolution of the default and automatic backends
+    TEST_CASE ("ResolveBackendTest")
+    {
+        FFTBackend defaultBackend = FFTEngine<float>::resolveBackend (DefaultFFTBackend, 512);
+        CHECK (FFTEngine<float>::isBackendAvailable (defaultBackend, 512));
+        
+        FFTBackend fastestBackend = FFTEngine<float>::findFastestBackend (512);
+        CHECK (FFTEngine<float>::isBackendAvailable (fastestBackend, 512));
+        CHECK_EQ (FFTEngine<float>::findFastestBackend (512), fastestBackend);
+        CHECK_EQ (FFTEngine<float>::resolveBackend (AutomaticFFTBackend, 512), fastestBackend);
+        
+        Gist<float> g (512, 44100, HanningWindow, AutomaticFFTBackend);
+        CHECK_EQ (g.getFFTBackend(), fastestBackend);
+        
+        // unavailable backends fall back to the default
+        if (! FFTEngine<float>::isBackendAvailable (FFTWBackend, 512))
+            CHECK_EQ (FFTEngine<float>::resolveBackend (FFTWBackend, 512), defaultBackend);
+    }
+    
+    // ------------------------------------------------------------
+    // 3. Check that the backend can be changed after construction
+    TEST_CASE ("SetFFTBackendTest")
+    {
+        Gist<float> g (256, 44100);
+        
+        g.setFFTBackend (KissFFTBackend);
+        CHECK_EQ (g.getFFTBackend(), KissFFTBackend);
+        
+        g.setFFTBackend (SimdFFTBackend);
+        CHECK_EQ (g.getFFTBackend(), SimdFFTBackend);
+        
+        g.setAudioFrameSize (300);
+        CHECK_EQ (g.getFFTBackend(), SimdFFTBackend);
+    }
+}
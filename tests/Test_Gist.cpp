@@ -101,6 +101,70 @@ TEST_SUITE ("GistTest")
     }
 
 
+    //=============================================================
+    TEST_CASE ("TestFFT_EvenFrameSizeMatchesDFT")
+    {
+        int frameSize = 512;
+        Gist<double> g (frameSize, 44100, WindowType::RectangularWindow);
+        
+        std::vector<double> testFrame (frameSize);
+        
+        for (int i = 0; i < frameSize; i++)
+            testFrame[i] = ((double)((rand() % 1000) - 500)) / 1000.;
+        
+        g.processAudioFrame (testFrame);
+        
+        const std::vector<double>& mag = g.getMagnitudeSpectrum();
+        
+        CHECK_EQ (mag.size(), frameSize / 2);
+        
+        for (size_t k = 0; k < mag.size(); k++)
+        {
+            double real = 0;
+            double imag = 0;
+            
+            for (int n = 0; n < frameSize; n++)
+            {
+                real += testFrame[n] * cos (2. * M_PI * k * n / frameSize);
+                imag -= testFrame[n] * sin (2. * M_PI * k * n / frameSize);
+            }
+            
+            CHECK (mag[k] == doctest::Approx (sqrt (real * real + imag * imag)).epsilon (0.0001));
+        }
+    }
+    
+    //=============================================================
+    TEST_CASE ("TestFFT_OddFrameSizeMatchesDFT")
+    {
+        int frameSize = 255;
+        Gist<double> g (frameSize, 44100, WindowType::RectangularWindow);
+        
+        std::vector<double> testFrame (frameSize);
+        
+        for (int i = 0; i < frameSize; i++)
+            testFrame[i] = ((double)((rand() % 1000) - 500)) / 1000.;
+        
+        g.processAudioFrame (testFrame);
+        
+        const std::vector<double>& mag = g.getMagnitudeSpectrum();
+        
+        CHECK_EQ (mag.size(), frameSize / 2);
+        
+        for (size_t k = 0; k < mag.size(); k++)
+        {
+            double real = 0;
+            double imag = 0;
+            
+            for (int n = 0; n < frameSize; n++)
+            {
+                real += testFrame[n] * cos (2. * M_PI * k * n / frameSize);
+                imag -= testFrame[n] * sin (2. * M_PI * k * n / frameSize);
+            }
+            
+            CHECK (mag[k] == doctest::Approx (sqrt (real * real + imag * imag)).epsilon (0.0001));
+        }
+    }
+
     //=============================================================
     TEST_CASE ("RMS_Test")
     {
@@ -191,4 +255,438 @@ TEST_SUITE ("GistTest")
         
         CHECK_EQ (r1, r2);
     }
+
+    //=============================================================
+    TEST_CASE ("LazyEvaluation_Test")
+    {
+        Gist<float> g1 (512, 44100);
+        Gist<float> g2 (512, 44100);
+        
+        std::vector<float> frame1 (512), frame2 (512);
+        
+        for (int i = 0; i < 512; i++)
+        {
+            frame1[i] = ((float)((rand() % 1000) - 500)) / 1000.;
+            frame2[i] = ((float)((rand() % 1000) - 500)) / 1000.;
+        }
+        
+        // features must not depend on the order they are asked for in
+        g1.processAudioFrame (frame1);
+        g2.processAudioFrame (frame1);
+        
+        std::vector<float> mfccs1 = g1.getMelFrequencyCepstralCoefficients();
+        std::vector<float> melSpectrum1 = g1.getMelFrequencySpectrum();
+        
+        std::vector<float> melSpectrum2 = g2.getMelFrequencySpectrum();
+        std::vector<float> mfccs2 = g2.getMelFrequencyCepstralCoefficients();
+        
+        CHECK (mfccs1 == mfccs2);
+        CHECK (melSpectrum1 == melSpectrum2);
+        
+        // a new frame must replace everything computed for the previous one
+        std::vector<float> magnitudeSpectrum1 = g1.getMagnitudeSpectrum();
+        
+        g1.processAudioFrame (frame2);
+        g2.processAudioFrame (frame2);
+        g2.rootMeanSquare();
+        
+        CHECK (g1.getMagnitudeSpectrum() != magnitudeSpectrum1);
+        CHECK (g1.getMagnitudeSpectrum() == g2.getMagnitudeSpectrum());
+        CHECK (g1.getMelFrequencyCepstralCoefficients() != mfccs1);
+    }
+
+    //=============================================================
+    TEST_CASE ("PowerSpectrum_Test")
+    {
+        Gist<double> g (1024, 44100);
+        
+        std::vector<double> frame (1024);
+        
+        for (int i = 0; i < 1024; i++)
+            frame[i] = ((double)((rand() % 1000) - 500)) / 1000.;
+        
+        g.processAudioFrame (frame);
+        
+        // the features built on the power spectrum must agree with working from the magnitudes
+        std::vector<double> powerSpectrum = g.getPowerSpectrum();
+        std::vector<double> magnitudeSpectrum = g.getMagnitudeSpectrum();
+        
+        REQUIRE_EQ (powerSpectrum.size(), magnitudeSpectrum.size());
+        
+        bool powerMatchesMagnitude = true;
+        
+        for (size_t i = 0; i < powerSpectrum.size(); i++)
+            powerMatchesMagnitude &= fabs (powerSpectrum[i] - magnitudeSpectrum[i] * magnitudeSpectrum[i]) <= 1e-9 * (1. + powerSpectrum[i]);
+        
+        CHECK (powerMatchesMagnitude);
+        
+        CoreFrequencyDomainFeatures<double> fdf;
+        CHECK (g.spectralCrest() == doctest::Approx (fdf.spectralCrest (magnitudeSpectrum)));
+        
+        MFCC<double> mfcc (1024, 44100);
+        mfcc.calculateMelFrequencySpectrum (magnitudeSpectrum);
+        
+        const std::vector<double>& melSpectrum = g.getMelFrequencySpectrum();
+        
+        for (size_t i = 0; i < melSpectrum.size(); i++)
+            CHECK (melSpectrum[i] == doctest::Approx (mfcc.melSpectrum[i]));
+    }
+
+    //=============================================================
+    TEST_CASE ("ComputeFeatures_Test")
+    {
+        const GistFeatureSet features = RootMeanSquareFeature | PeakEnergyFeature | ZeroCrossingRateFeature
+                                      | SpectralCentroidFeature | SpectralCrestFeature | SpectralFlatnessFeature
+                                      | SpectralRolloffFeature | SpectralKurtosisFeature | EnergyDifferenceFeature
+                                      | SpectralDifferenceFeature | SpectralDifferenceHWRFeature | ComplexSpectralDifferenceFeature
+                                      | HighFrequencyContentFeature | PitchFeature | MelFrequencyCepstralCoefficientsFeature;
+        
+        Gist<double> g1 (1024, 44100);
+        Gist<double> g2 (1024, 44100);
+        
+        int numValues = g1.getNumFeatureValues (features);
+        CHECK_EQ (numValues, 14 + 13);
+        CHECK_EQ (g1.getNumFeatureValues (PitchFeature | ZeroCrossingRateFeature), 2);
+        
+        std::vector<double> frame (1024);
+        std::vector<double> output (numValues);
+        
+        // several frames, so that the onset detection function histories are exercised
+        for (int frameIndex = 0; frameIndex < 4; frameIndex++)
+        {
+            for (int i = 0; i < 1024; i++)
+                frame[i] = ((double)((rand() % 1000) - 500)) / 1000. * sin (i * 0.05 * (frameIndex + 1));
+            
+            g1.processAudioFrame (frame);
+            g1.computeFeatures (features, output.data());
+            
+            g2.processAudioFrame (frame);
+            std::vector<double> expected = {g2.rootMeanSquare(), g2.peakEnergy(), g2.zeroCrossingRate(),
+                                            g2.spectralCentroid(), g2.spectralCrest(), g2.spectralFlatness(),
+                                            g2.spectralRolloff(), g2.spectralKurtosis(), g2.energyDifference(),
+                                            g2.spectralDifference(), g2.spectralDifferenceHWR(), g2.complexSpectralDifference(),
+                                            g2.highFrequencyContent(), g2.pitch()};
+            
+            const std::vector<double>& mfccs = g2.getMelFrequencyCepstralCoefficients();
+            expected.insert (expected.end(), mfccs.begin(), mfccs.end());
+            
+            for (int i = 0; i < numValues; i++)
+                CHECK (output[i] == doctest::Approx (expected[i]));
+        }
+    }
+
+    //=============================================================
+    TEST_CASE ("Analyse_Test")
+    {
+        const GistFeatureSet features = RootMeanSquareFeature | ZeroCrossingRateFeature | SpectralCentroidFeature
+                                      | EnergyDifferenceFeature | SpectralDifferenceFeature | PitchFeature
+                                      | MelFrequencyCepstralCoefficientsFeature;
+        const int frameSize = 512;
+        const int hopSize = 256;
+        
+        Gist<double> g1 (frameSize, 44100);
+        Gist<double> g2 (frameSize, 44100);
+        
+        std::vector<double> signal (frameSize * 6 + 100);
+        
+        for (size_t i = 0; i < signal.size(); i++)
+            signal[i] = ((double)((rand() % 1000) - 500)) / 1000. * sin (i * 0.03);
+        
+        std::vector<double> output;
+        g1.analyse (signal.data(), signal.size(), hopSize, features, output);
+        
+        size_t numFrames = g1.getNumAnalysisFrames (signal.size(), hopSize);
+        int numValues = g1.getNumFeatureValues (features);
+        CHECK_EQ (numFrames, (signal.size() - frameSize) / hopSize + 1);
+        CHECK_EQ (output.size(), numFrames * numValues);
+        
+        std::vector<double> expected (numValues);
+        
+        for (size_t frame = 0; frame < numFrames; frame++)
+        {
+            g2.processAudioFrame (signal.data() + frame * hopSize, frameSize);
+            g2.computeFeatures (features, expected.data());
+            
+            for (int i = 0; i < numValues; i++)
+                CHECK (output[frame * numValues + i] == expected[i]);
+        }
+        
+        // too short for a single frame
+        g1.analyse (signal.data(), frameSize - 1, hopSize, features, output);
+        CHECK (output.empty());
+    }
+
+    //=============================================================
+    TEST_CASE ("ProcessAudioStream_Test")
+    {
+        const GistFeatureSet features = RootMeanSquareFeature | ZeroCrossingRateFeature | SpectralCentroidFeature
+                                      | SpectralDifferenceFeature | PitchFeature;
+        const int frameSize = 512;
+        
+        std::vector<double> signal (frameSize * 8 + 37);
+        
+        for (size_t i = 0; i < signal.size(); i++)
+            signal[i] = ((double)((rand() % 1000) - 500)) / 1000. * sin (i * 0.02);
+        
+        // overlapping, contiguous and gapped frames
+        for (int hopSize : {128, 441, 512, 700})
+        {
+            Gist<double> g1 (frameSize, 44100);
+            Gist<double> g2 (frameSize, 44100);
+            
+            g1.setHopSize (hopSize);
+            CHECK_EQ (g1.getHopSize(), hopSize);
+            
+            int numValues = g1.getNumFeatureValues (features);
+            std::vector<double> expected;
+            g2.analyse (signal.data(), signal.size(), hopSize, features, expected);
+            
+            std::vector<double> output;
+            std::vector<double> values (numValues);
+            
+            // blocks of varying sizes, unrelated to the frame and hop sizes
+            size_t position = 0;
+            int blockSize = 1;
+            
+            while (position < signal.size())
+            {
+                size_t numSamples = std::min (static_cast<size_t> (blockSize), signal.size() - position);
+                
+                g1.processAudioStream (signal.data() + position, numSamples, [&]()
+                {
+                    g1.computeFeatures (features, values.data());
+                    output.insert (output.end(), values.begin(), values.end());
+                });
+                
+                position += numSamples;
+                blockSize = (blockSize * 7 + 3) % 300 + 1;
+            }
+            
+            REQUIRE_EQ (output.size(), expected.size());
+            
+            for (size_t i = 0; i < output.size(); i++)
+                CHECK (output[i] == expected[i]);
+        }
+    }
+
+    //=============================================================
+    TEST_CASE ("StreamAfterFrameSizeChange_Test")
+    {
+        std::vector<double> signal (4096);
+        
+        for (size_t i = 0; i < signal.size(); i++)
+            signal[i] = ((double)((rand() % 1000) - 500)) / 1000. * sin (i * 0.02);
+        
+        // the stream buffer is laid out again for the new frame size when streaming resumes
+        Gist<double> g1 (512, 44100);
+        Gist<double> g2 (1024, 44100);
+        g1.setHopSize (256);
+        g2.setHopSize (256);
+        
+        g1.processAudioStream (signal.data(), 1000, []() {});
+        g1.setAudioFrameSize (1024);
+        
+        std::vector<double> output, expected;
+        
+        g1.processAudioStream (signal.data(), signal.size(), [&]() { output.push_back (g1.rootMeanSquare()); });
+        g2.processAudioStream (signal.data(), signal.size(), [&]() { expected.push_back (g2.rootMeanSquare()); });
+        
+        CHECK_EQ (output.size(), 13);
+        CHECK (output == expected);
+    }
+
+    //=============================================================
+    TEST_CASE ("SharedPlan_Test")
+    {
+        const GistFeatureSet features = RootMeanSquareFeature | SpectralCentroidFeature | SpectralDifferenceFeature
+                                      | ComplexSpectralDifferenceFeature | PitchFeature | MelFrequencyCepstralCoefficientsFeature;
+        const int frameSize = 512;
+        const int hopSize = 256;
+        
+        std::vector<double> signal (frameSize * 6);
+        
+        for (size_t i = 0; i < signal.size(); i++)
+            signal[i] = ((double)((rand() % 1000) - 500)) / 1000. * sin (i * 0.03);
+        
+        GistPlan<double>::Settings settings (frameSize, 16000);
+        settings.numMFCCs = 20;
+        settings.numMelBands = 40;
+        
+        std::shared_ptr<const GistPlan<double>> plan = GistPlan<double>::create (settings);
+        
+        // streams sharing a plan keep their histories apart, and match a Gist with a plan of its own
+        Gist<double> stream1 (plan);
+        Gist<double> stream2 (plan);
+        Gist<double> reference (frameSize, 16000);
+        reference.setNumMFCCs (20);
+        reference.setNumMelBands (40);
+        
+        CHECK ((stream1.getPlan() == plan));
+        CHECK ((stream2.getPlan() == plan));
+        CHECK ((reference.getPlan() != plan));
+        
+        std::vector<double> expected, output1, output2;
+        reference.analyse (signal.data(), signal.size(), hopSize, features, expected);
+        stream1.analyse (signal.data(), signal.size(), hopSize, features, output1);
+        
+        // the second stream analyses the signal in reverse first, which must not affect the first stream
+        std::vector<double> reversed (signal.rbegin(), signal.rend());
+        stream2.analyse (reversed.data(), reversed.size(), hopSize, features, output2);
+        
+        REQUIRE_EQ (output1.size(), expected.size());
+        
+        for (size_t i = 0; i < output1.size(); i++)
+            CHECK (output1[i] == expected[i]);
+        
+        // changing a setting gives a stream a plan of its own, leaving the shared one as it was
+        stream2.setNumMFCCs (13);
+        
+        CHECK ((stream2.getPlan() != plan));
+        CHECK_EQ (plan->getSettings().numMFCCs, 20);
+        CHECK_EQ (stream1.getNumFeatureValues (MelFrequencyCepstralCoefficientsFeature), 20);
+        CHECK_EQ (stream2.getNumFeatureValues (MelFrequencyCepstralCoefficientsFeature), 13);
+        
+        stream2.setPlan (plan);
+        CHECK ((stream2.getPlan() == plan));
+        CHECK_EQ (stream2.getNumFeatureValues (MelFrequencyCepstralCoefficientsFeature), 20);
+    }
+
+    //=============================================================
+    TEST_CASE ("IncrementalPitchSkippedFrames_Test")
+    {
+        const int frameSize = 1024;
+        const int hopSize = 256;
+        const int sampleRate = 16000;
+        
+        // a step from 220 Hz to 330 Hz half way through
+        std::vector<double> signal (frameSize + hopSize * 40);
+        
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            double frequency = i < signal.size() / 2 ? 220. : 330.;
+            signal[i] = sin (2. * M_PI * frequency * i / sampleRate);
+        }
+        
+        Gist<double> incremental (frameSize, sampleRate);
+        Gist<double> direct (frameSize, sampleRate);
+        incremental.setYinDifferenceMethod (IncrementalDifference);
+        incremental.setHopSize (hopSize);
+        direct.setHopSize (hopSize);
+        
+        std::vector<double> incrementalPitches, directPitches;
+        int numFrames = 0;
+        
+        // the pitch is only asked for on every third frame
+        incremental.processAudioStream (signal.data(), signal.size(), [&]()
+        {
+            if (numFrames++ % 3 == 0)
+                incrementalPitches.push_back (incremental.pitch());
+        });
+        
+        numFrames = 0;
+        
+        direct.processAudioStream (signal.data(), signal.size(), [&]()
+        {
+            if (numFrames++ % 3 == 0)
+                directPitches.push_back (direct.pitch());
+        });
+        
+        REQUIRE_EQ (incrementalPitches.size(), directPitches.size());
+        
+        for (size_t i = 0; i < incrementalPitches.size(); i++)
+            CHECK (incrementalPitches[i] == doctest::Approx (directPitches[i]).epsilon (1e-6));
+        
+        // and the same for frames passed to processAudioFrame()
+        incrementalPitches.clear();
+        directPitches.clear();
+        
+        for (int frame = 0; frame < 40; frame++)
+        {
+            incremental.processAudioFrame (signal.data() + frame * hopSize, frameSize);
+            direct.processAudioFrame (signal.data() + frame * hopSize, frameSize);
+            
+            if (frame % 3 == 0)
+            {
+                incrementalPitches.push_back (incremental.pitch());
+                directPitches.push_back (direct.pitch());
+            }
+        }
+        
+        for (size_t i = 0; i < incrementalPitches.size(); i++)
+            CHECK (incrementalPitches[i] == doctest::Approx (directPitches[i]).epsilon (1e-6));
+    }
+
+    //=============================================================
+    TEST_CASE ("ChangingOnsetDetectionFeatures_Test")
+    {
+        Gist<double> changing (1024, 44100);
+        Gist<double> single (1024, 44100);
+        Gist<double> individual (1024, 44100);
+        
+        std::vector<double> frame (1024);
+        double output[2];
+        
+        // the feature set changes after five frames, which must not leave a stale history behind
+        for (int frameIndex = 0; frameIndex < 10; frameIndex++)
+        {
+            for (int i = 0; i < 1024; i++)
+                frame[i] = ((double)((rand() % 1000) - 500)) / 1000. * sin (i * 0.05 * (frameIndex + 1));
+            
+            changing.processAudioFrame (frame);
+            single.processAudioFrame (frame);
+            individual.processAudioFrame (frame);
+            
+            if (frameIndex < 5)
+                changing.computeFeatures (SpectralDifferenceFeature | SpectralDifferenceHWRFeature, output);
+            else
+                changing.computeFeatures (SpectralDifferenceFeature, output);
+            
+            double expected[1];
+            single.computeFeatures (SpectralDifferenceFeature, expected);
+            
+            CHECK (output[0] == doctest::Approx (expected[0]));
+            CHECK (individual.spectralDifference() == doctest::Approx (expected[0]));
+            
+            // asking again for the same frame must not move the history on
+            CHECK_EQ (individual.spectralDifference(), individual.spectralDifference());
+            CHECK_EQ (changing.spectralDifference(), output[0]);
+        }
+    }
+
+    //=============================================================
+    TEST_CASE ("ComplexSpectralDifferenceFullSpectrum_Test")
+    {
+        const int frameSize = 512;
+        
+        Gist<double> g (frameSize, 44100);
+        OnsetDetectionFunction<double> reference (frameSize);
+        std::vector<double> window = WindowFunctions<double>::createWindow (frameSize, HanningWindow);
+        
+        std::vector<double> frame (frameSize);
+        std::vector<double> fullReal (frameSize), fullImag (frameSize);
+        
+        // the half spectrum Gist works from must give the value of the full (mirrored) spectrum
+        for (int frameIndex = 0; frameIndex < 5; frameIndex++)
+        {
+            for (int i = 0; i < frameSize; i++)
+                frame[i] = ((double)((rand() % 1000) - 500)) / 1000. * sin (i * 0.05 * (frameIndex + 1));
+            
+            for (int k = 0; k < frameSize; k++)
+            {
+                fullReal[k] = 0;
+                fullImag[k] = 0;
+                
+                for (int n = 0; n < frameSize; n++)
+                {
+                    double angle = 2. * M_PI * ((k * n) % frameSize) / frameSize;
+                    fullReal[k] += frame[n] * window[n] * cos (angle);
+                    fullImag[k] -= frame[n] * window[n] * sin (angle);
+                }
+            }
+            
+            g.processAudioFrame (frame);
+            
+            CHECK (g.complexSpectralDifference() == doctest::Approx (reference.complexSpectralDifference (fullReal, fullImag)).epsilon (1e-9));
+        }
+    }
 }
@@ -1,6 +1,7 @@
 #include "doctest.h"
 #include <Gist.h>
 #include "Test_Signals.h"
+#include <algorithm>
 
 //=============================================================
 //========================== MFCC =============================
@@ -27,4 +28,173 @@ TEST_SUITE ("MFCC_test")
             CHECK (mfcc.MFCCs[i] == doctest::Approx (mfccTest1_result[i]).epsilon (0.01));
         }
     }
+
+    // ------------------------------------------------------------
+    // 2. CHECK THE TRIANGULAR FILTERS ONE BIN AT A TIME
+    TEST_CASE ("FilterBankTest")
+    {
+        for (int frameSize : {256, 1000, 2048})
+        {
+            MFCC<double> mfcc (frameSize, 44100);
+            mfcc.setNumCoefficients (40);
+            
+            std::vector<double> spectrum (frameSize / 2, 0.0);
+            bool weightsAreInRange = true;
+            bool bandsAreNeighbours = true;
+            int maxFiltersCoveringBin = 0;
+            
+            for (int bin = 0; bin < frameSize / 2; bin++)
+            {
+                spectrum[bin] = 1.0;
+                mfcc.calculateMelFrequencySpectrum (spectrum);
+                spectrum[bin] = 0.0;
+                
+                // a bin contributes its filter weights, and only to neighbouring bands
+                int firstBand = -1;
+                int numFiltersCoveringBin = 0;
+                
+                for (int band = 0; band < 40; band++)
+                {
+                    weightsAreInRange = weightsAreInRange && mfcc.melSpectrum[band] >= 0.0 && mfcc.melSpectrum[band] <= 1.0;
+                    
+                    if (mfcc.melSpectrum[band] > 0.0)
+                    {
+                        if (firstBand == -1)
+                            firstBand = band;
+                        
+                        bandsAreNeighbours = bandsAreNeighbours && band <= firstBand + 1;
+                        numFiltersCoveringBin++;
+                    }
+                }
+                
+                maxFiltersCoveringBin = std::max (maxFiltersCoveringBin, numFiltersCoveringBin);
+            }
+            
+            CHECK (weightsAreInRange);
+            CHECK (bandsAreNeighbours);
+            
+            // filters overlap by half, so each bin is covered by at most two
+            CHECK (maxFiltersCoveringBin == 2);
+        }
+    }
+
+    // ------------------------------------------------------------
+    // 3. CHECK THE DISCRETE COSINE TRANSFORM, WITH AND WITHOUT THE FFT
+    TEST_CASE ("DiscreteCosineTransformTest")
+    {
+        for (int numCoefficients : {13, 40, 127, 128, 200, 257})
+        {
+            MFCC<double> mfcc (4096, 44100);
+            mfcc.setNumCoefficients (numCoefficients);
+            
+            std::vector<double> spectrum (2048);
+            
+            for (size_t i = 0; i < spectrum.size(); i++)
+                spectrum[i] = 1.0 + 0.5 * sin (i * 0.01) + ((double)(rand() % 1000)) / 1000.;
+            
+            mfcc.calculateMelFrequencyCepstralCoefficients (spectrum);
+            
+            for (int k = 0; k < numCoefficients; k++)
+            {
+                double expected = 0;
+                
+                for (int n = 0; n < numCoefficients; n++)
+                    expected += 2. * log (mfcc.melSpectrum[n] + FLT_MIN) * cos (M_PI / numCoefficients * (n + 0.5) * k);
+                
+                CHECK (mfcc.MFCCs[k] == doctest::Approx (expected).epsilon (1e-9).scale (1.0));
+            }
+        }
+    }
+
+    // ------------------------------------------------------------
+    // 4. CHECK THE NUMBER OF MEL BANDS CAN DIFFER FROM THE NUMBER OF COEFFICIENTS
+    TEST_CASE ("MelBandsTest")
+    {
+        std::vector<double> spectrum (1024);
+        
+        for (size_t i = 0; i < spectrum.size(); i++)
+            spectrum[i] = 1.0 + ((double)(rand() % 1000)) / 1000.;
+        
+        for (int numBands : {40, 128})
+        {
+            MFCC<double> all (2048, 44100);
+            all.setNumCoefficients (numBands);
+            
+            MFCC<double> truncated (2048, 44100);
+            truncated.setNumMelBands (numBands);
+            truncated.setNumCoefficients (13);
+            
+            all.calculateMelFrequencyCepstralCoefficients (spectrum);
+            truncated.calculateMelFrequencyCepstralCoefficients (spectrum);
+            
+            CHECK_EQ (truncated.melSpectrum.size(), numBands);
+            REQUIRE_EQ (truncated.MFCCs.size(), 13);
+            CHECK (truncated.melSpectrum == all.melSpectrum);
+            
+            for (int i = 0; i < 13; i++)
+                CHECK (truncated.MFCCs[i] == doctest::Approx (all.MFCCs[i]).epsilon (1e-9).scale (1.0));
+        }
+        
+        // no more coefficients than bands
+        MFCC<double> mfcc (2048, 44100);
+        mfcc.setNumMelBands (10);
+        mfcc.setNumCoefficients (20);
+        CHECK_EQ (mfcc.MFCCs.size(), 10);
+    }
+    
+    // ------------------------------------------------------------
+    // 5. CHECK THE FREQUENCY RANGE OF THE FILTER BANK
+    TEST_CASE ("FrequencyRangeTest")
+    {
+        const int frameSize = 2048;
+        const int fs = 16000;
+        
+        MFCC<double> mfcc (frameSize, fs);
+        mfcc.setNumMelBands (40);
+        mfcc.setFrequencyRange (300, 3400);
+        
+        std::vector<double> spectrum (frameSize / 2, 0.0);
+        
+        // below the range: no band picks it up
+        spectrum[(int)(200. * frameSize / fs)] = 1.0;
+        mfcc.calculateMelFrequencySpectrum (spectrum);
+        
+        for (double value : mfcc.melSpectrum)
+            CHECK_EQ (value, 0.0);
+        
+        // within the range
+        std::fill (spectrum.begin(), spectrum.end(), 0.0);
+        spectrum[(int)(1000. * frameSize / fs)] = 1.0;
+        mfcc.calculateMelFrequencySpectrum (spectrum);
+        CHECK (*std::max_element (mfcc.melSpectrum.begin(), mfcc.melSpectrum.end()) > 0.0);
+        
+        // above the range
+        std::fill (spectrum.begin(), spectrum.end(), 0.0);
+        spectrum[(int)(5000. * frameSize / fs)] = 1.0;
+        mfcc.calculateMelFrequencySpectrum (spectrum);
+        
+        for (double value : mfcc.melSpectrum)
+            CHECK_EQ (value, 0.0);
+    }
+    
+    // ------------------------------------------------------------
+    // 6. CHECK THE SETTINGS THROUGH GIST
+    TEST_CASE ("GistSettingsTest")
+    {
+        Gist<float> gist (1024, 16000);
+        gist.setNumMelBands (40);
+        gist.setNumMFCCs (20);
+        gist.setMelFrequencyRange (60, 7600);
+        
+        std::vector<float> frame (1024);
+        
+        for (int i = 0; i < 1024; i++)
+            frame[i] = (float)sin (i * 0.1);
+        
+        gist.processAudioFrame (frame);
+        
+        CHECK_EQ (gist.getMelFrequencySpectrum().size(), 40);
+        CHECK_EQ (gist.getMelFrequencyCepstralCoefficients().size(), 20);
+        CHECK_EQ (gist.getNumFeatureValues (MelFrequencySpectrumFeature | MelFrequencyCepstralCoefficientsFeature), 60);
+    }
 }
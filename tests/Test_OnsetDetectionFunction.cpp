@@ -1,6 +1,51 @@
 #include "doctest.h"
 #include <Gist.h>
 
+//=============================================================
+/** The complex spectral difference as it was calculated from explicit
+ * phases, kept as a reference for the phasor-based implementation */
+template <class T>
+class PhaseComplexSpectralDifference
+{
+public:
+    PhaseComplexSpectralDifference (size_t numBins)
+     :  prevPhase (numBins, 0), prevPhase2 (numBins, 0), prevMagnitude (numBins, 0)
+    {
+    }
+    
+    T process (const std::vector<T>& fftReal, const std::vector<T>& fftImag)
+    {
+        T sum = 0;
+        
+        for (size_t i = 0; i < fftReal.size(); i++)
+        {
+            T phaseVal = atan2 (fftImag[i], fftReal[i]);
+            T magVal = sqrt ((fftReal[i] * fftReal[i]) + (fftImag[i] * fftImag[i]));
+            T dev = phaseVal - (2 * prevPhase[i]) + prevPhase2[i];
+            
+            while (dev <= -M_PI)
+                dev += 2 * M_PI;
+            
+            while (dev > M_PI)
+                dev -= 2 * M_PI;
+            
+            T magDiff = magVal - prevMagnitude[i];
+            T phaseDiff = -magVal * sin (dev);
+            
+            sum += sqrt ((magDiff * magDiff) + (phaseDiff * phaseDiff));
+            
+            prevPhase2[i] = prevPhase[i];
+            prevPhase[i] = phaseVal;
+            prevMagnitude[i] = magVal;
+        }
+        
+        return sum;
+    }
+    
+private:
+    std::vector<T> prevPhase, prevPhase2, prevMagnitude;
+};
+
 //=============================================================
 //=================== SPECTRAL DIFFERENCE =====================
 //=============================================================
@@ -171,3 +216,134 @@ TEST_SUITE ("SpectralDifferenceHWR")
         CHECK_EQ (r, 0);
     }
 }
+
+//=============================================================
+//======================= COMPUTE ALL =========================
+//=============================================================
+TEST_SUITE ("ComputeAll")
+{
+    // ------------------------------------------------------------
+    // 1. Check that computeAll() agrees with the individual functions over a stream of frames
+    TEST_CASE ("MatchesIndividualFunctionsTest")
+    {
+        int frameSize = 512;
+        
+        OnsetDetectionFunction<double> combined (frameSize);
+        OnsetDetectionFunction<double> individual (frameSize);
+        
+        std::vector<double> fftReal (frameSize / 2 + 1);
+        std::vector<double> fftImag (frameSize / 2 + 1);
+        std::vector<double> magnitudeSpectrum (frameSize / 2);
+        
+        for (int frame = 0; frame < 6; frame++)
+        {
+            for (int i = 0; i < frameSize / 2 + 1; i++)
+            {
+                fftReal[i] = ((double)((rand() % 1000) - 500)) / 100.;
+                fftImag[i] = ((double)((rand() % 1000) - 500)) / 100.;
+            }
+            
+            for (int i = 0; i < frameSize / 2; i++)
+                magnitudeSpectrum[i] = sqrt ((fftReal[i] * fftReal[i]) + (fftImag[i] * fftImag[i]));
+            
+            OnsetDetectionFunction<double>::Samples samples = combined.computeAll (magnitudeSpectrum, fftReal, fftImag);
+            
+            CHECK (samples.spectralDifference == doctest::Approx (individual.spectralDifference (magnitudeSpectrum)));
+            CHECK (samples.spectralDifferenceHWR == doctest::Approx (individual.spectralDifferenceHWR (magnitudeSpectrum)));
+            CHECK (samples.complexSpectralDifference == doctest::Approx (individual.complexSpectralDifference (fftReal, fftImag)));
+            CHECK (samples.highFrequencyContent == doctest::Approx (individual.highFrequencyContent (magnitudeSpectrum)));
+        }
+    }
+}
+
+//=============================================================
+//================ COMPLEX SPECTRAL DIFFERENCE ================
+//=============================================================
+TEST_SUITE ("ComplexSpectralDifference")
+{
+    // ------------------------------------------------------------
+    // 1. Check the phasor-based calculation against the explicit phase one, over a
+    // stream that includes silent frames, empty bins and a steady sinusoid
+    template <class T>
+    void checkAgainstPhaseCalculation (double epsilon)
+    {
+        const int frameSize = 1024;
+        const int numBins = frameSize / 2 + 1;
+        
+        OnsetDetectionFunction<T> odf (frameSize);
+        PhaseComplexSpectralDifference<T> reference (frameSize);
+        
+        std::vector<T> fftReal (numBins);
+        std::vector<T> fftImag (numBins);
+        std::vector<T> fullReal (frameSize);
+        std::vector<T> fullImag (frameSize);
+        
+        for (int frame = 0; frame < 12; frame++)
+        {
+            for (int i = 0; i < numBins; i++)
+            {
+                if (frame < 2)
+                {
+                    // silence, so that the first sounding frames start from zero phases
+                    fftReal[i] = 0;
+                    fftImag[i] = 0;
+                }
+                else if (frame < 6)
+                {
+                    // a bin whose phase advances steadily, which the prediction cancels
+                    T magnitude = (T)(1 + i % 7);
+                    T phase = (T)(0.3 * i * frame);
+                    fftReal[i] = magnitude * cos (phase);
+                    fftImag[i] = magnitude * sin (phase);
+                }
+                else
+                {
+                    fftReal[i] = ((T)((rand() % 1000) - 500)) / 100;
+                    fftImag[i] = i % 5 == 0 ? 0 : ((T)((rand() % 1000) - 500)) / 100;
+                }
+            }
+            
+            // the reference works from the full spectrum, with the upper half mirrored from the lower
+            for (int i = 0; i < frameSize; i++)
+            {
+                int bin = i < numBins ? i : frameSize - i;
+                fullReal[i] = fftReal[bin];
+                fullImag[i] = i < numBins ? fftImag[bin] : -fftImag[bin];
+            }
+            
+            T expected = reference.process (fullReal, fullImag);
+            T result = odf.complexSpectralDifference (fftReal, fftImag);
+            
+            // the rounding errors of both calculations scale with the magnitudes summed over,
+            // rather than with the result, which is tiny when the prediction cancels each bin
+            double magnitudeSum = 0;
+            
+            for (int i = 0; i < frameSize; i++)
+                magnitudeSum += sqrt ((double)fullReal[i] * fullReal[i] + (double)fullImag[i] * fullImag[i]);
+            
+            CHECK (fabs ((double)result - (double)expected) <= epsilon * (1. + magnitudeSum));
+        }
+    }
+    
+    TEST_CASE ("MatchesPhaseCalculationDoubleTest")
+    {
+        checkAgainstPhaseCalculation<double> (1e-12);
+    }
+    
+    TEST_CASE ("MatchesPhaseCalculationFloatTest")
+    {
+        checkAgainstPhaseCalculation<float> (1e-5);
+    }
+    
+    // ------------------------------------------------------------
+    // 2. Check that a buffer of zeros returns zero on two occasions
+    TEST_CASE ("Zero_Test")
+    {
+        OnsetDetectionFunction<float> odf (512);
+        
+        std::vector<float> zeros (257, 0.f);
+        
+        CHECK_EQ (odf.complexSpectralDifference (zeros, zeros), 0);
+        CHECK_EQ (odf.complexSpectralDifference (zeros, zeros), 0);
+    }
+}
@@ -89,3 +89,339 @@ TEST_SUITE ("PitchYin")
         CHECK_EQ (r, y.getMaxFrequency());
     }
 }
+
+//=============================================================
+//================ YIN FFT DIFFERENCE FUNCTION ================
+//=============================================================
+TEST_SUITE ("PitchYinFFT")
+{
+    // ------------------------------------------------------------
+    TEST_CASE ("KnownBuffersTest")
+    {
+        Yin<float> y (44100);
+        y.setDifferenceMethod (FFTDifference);
+        CHECK_EQ (y.getDifferenceMethod(), FFTDifference);
+        
+        std::vector<float> frame1 (pitchTest1, pitchTest1 + 512);
+        CHECK (y.pitchYin (frame1) == doctest::Approx (pitchTest1_result).epsilon (0.0001));
+        
+        std::vector<float> frame2 (pitchTest2, pitchTest2 + 512);
+        CHECK (y.pitchYin (frame2) == doctest::Approx (pitchTest2_result).epsilon (0.0001));
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("FlatBuffersTest")
+    {
+        Yin<float> y (44100);
+        y.setDifferenceMethod (FFTDifference);
+        
+        for (float value : {0.f, 1.f, -1.f})
+        {
+            std::vector<float> frame (512, value);
+            CHECK_EQ (y.pitchYin (frame), y.getMaxFrequency());
+        }
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("MatchesDirectMethodTest")
+    {
+        // includes a frame size that the SIMD FFT hands on to Kiss FFT
+        for (int frameSize : {256, 1000, 2048})
+        {
+            for (double frequency : {82.4, 220.0, 440.0, 1000.0})
+            {
+                Yin<double> direct (44100);
+                Yin<double> fft (44100);
+                fft.setDifferenceMethod (FFTDifference);
+                
+                std::vector<double> frame (frameSize);
+                
+                for (int i = 0; i < frameSize; i++)
+                    frame[i] = 0.8 * sin (2. * M_PI * frequency * i / 44100.) + 0.2 * sin (6. * M_PI * frequency * i / 44100.)
+                               + 0.05 * ((double)((rand() % 1000) - 500)) / 500.;
+                
+                CHECK (fft.pitchYin (frame) == doctest::Approx (direct.pitchYin (frame)).epsilon (0.0001));
+            }
+        }
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("GistTest")
+    {
+        Gist<float> g1 (2048, 44100);
+        Gist<float> g2 (2048, 44100);
+        g2.setYinDifferenceMethod (FFTDifference);
+        
+        std::vector<float> frame (2048);
+        
+        for (int i = 0; i < 2048; i++)
+            frame[i] = (float)sin (2. * M_PI * 330. * i / 44100.);
+        
+        g1.processAudioFrame (frame);
+        g2.processAudioFrame (frame);
+        
+        CHECK (g2.pitch() == doctest::Approx (g1.pitch()).epsilon (0.0001));
+        
+        // the shared engine follows changes of frame size and backend
+        g2.setFFTBackend (KissFFTBackend);
+        g2.setAudioFrameSize (1024);
+        g1.setAudioFrameSize (1024);
+        
+        frame.resize (1024);
+        g1.processAudioFrame (frame);
+        g2.processAudioFrame (frame);
+        
+        CHECK (g2.pitch() == doctest::Approx (g1.pitch()).epsilon (0.0001));
+    }
+}
+
+//=============================================================
+//==================== YIN SEARCH RANGE =======================
+//=============================================================
+TEST_SUITE ("PitchYinSearchRange")
+{
+    // ------------------------------------------------------------
+    std::vector<double> createPitchTestFrame (int frameSize, double frequency, int fs)
+    {
+        std::vector<double> frame (frameSize);
+        
+        for (int i = 0; i < frameSize; i++)
+            frame[i] = 0.7 * sin (2. * M_PI * frequency * i / fs) + 0.3 * sin (4. * M_PI * frequency * i / fs)
+                       + 0.02 * ((double)((rand() % 1000) - 500)) / 500.;
+        
+        return frame;
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("MaxFrequencyAtOtherSampleRatesTest")
+    {
+        // a 1 kHz period at 16 kHz is 16 samples, shorter than
+        // the minimum period of 30 samples that used to be fixed
+        Yin<double> y (16000);
+        y.setMaxFrequency (1500);
+        
+        std::vector<double> frame = createPitchTestFrame (1024, 1000., 16000);
+        
+        CHECK (y.pitchYin (frame) == doctest::Approx (1000.).epsilon (0.01));
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("MinFrequencyTest")
+    {
+        for (double frequency : {90., 150., 300., 600.})
+        {
+            Yin<double> bounded (16000);
+            Yin<double> unbounded (16000);
+            
+            CHECK_EQ (bounded.getMinFrequency(), 0);
+            bounded.setMinFrequency (80);
+            CHECK (bounded.getMinFrequency() == doctest::Approx (80.));
+            
+            std::vector<double> frame = createPitchTestFrame (2048, frequency, 16000);
+            double pitch = bounded.pitchYin (frame);
+            
+            CHECK (pitch == doctest::Approx (unbounded.pitchYin (frame)));
+            CHECK (pitch == doctest::Approx (frequency).epsilon (0.01));
+            
+            bounded.setMinFrequency (0);
+            CHECK_EQ (bounded.getMinFrequency(), 0);
+        }
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("EarlyExitTest")
+    {
+        Yin<double> y1 (44100);
+        Yin<double> y2 (44100);
+        y2.setEarlyExit (false);
+        
+        // a sequence of frames, so that the continuity with the previous estimate is exercised
+        for (double frequency : {110., 112., 220., 440., 441., 880., 300.})
+        {
+            std::vector<double> frame = createPitchTestFrame (2048, frequency, 44100);
+            CHECK_EQ (y1.pitchYin (frame), y2.pitchYin (frame));
+        }
+        
+        std::vector<double> silence (2048, 0.);
+        CHECK_EQ (y1.pitchYin (silence), y2.pitchYin (silence));
+    }
+}
+
+//=============================================================
+//================= YIN INCREMENTAL DIFFERENCE ================
+//=============================================================
+TEST_SUITE ("PitchYinIncremental")
+{
+    // ------------------------------------------------------------
+    std::vector<double> createGlidingSignal (int numSamples, int fs)
+    {
+        std::vector<double> signal (numSamples);
+        double phase = 0;
+        
+        for (int i = 0; i < numSamples; i++)
+        {
+            double frequency = 150. + 100. * i / numSamples;
+            phase += 2. * M_PI * frequency / fs;
+            signal[i] = 0.6 * sin (phase) + 0.3 * sin (2. * phase) + 0.01 * ((double)((rand() % 1000) - 500)) / 500.;
+        }
+        
+        return signal;
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("MatchesDirectMethodTest")
+    {
+        const int frameSize = 1024;
+        std::vector<double> signal = createGlidingSignal (44100, 44100);
+        
+        // hops that stay within and go past the resync interval
+        for (int hopSize : {64, 176, 511})
+        {
+            Yin<double> direct (44100);
+            Yin<double> incremental (44100);
+            incremental.setDifferenceMethod (IncrementalDifference);
+            incremental.setHopSize (hopSize);
+            
+            for (size_t start = 0; start + frameSize <= signal.size(); start += hopSize)
+                CHECK (incremental.pitchYin (signal.data() + start, frameSize) == doctest::Approx (direct.pitchYin (signal.data() + start, frameSize)).epsilon (1e-6));
+        }
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("BoundedRangeTest")
+    {
+        const int frameSize = 1024;
+        std::vector<double> signal = createGlidingSignal (16000, 16000);
+        
+        Yin<double> direct (16000);
+        Yin<double> incremental (16000);
+        direct.setMinFrequency (100);
+        incremental.setMinFrequency (100);
+        incremental.setDifferenceMethod (IncrementalDifference);
+        incremental.setHopSize (64);
+        
+        for (size_t start = 0; start + frameSize <= signal.size(); start += 64)
+        {
+            // a discontinuity half way through
+            if (start == 64 * 100)
+                incremental.resetIncrementalDifference();
+            
+            CHECK (incremental.pitchYin (signal.data() + start, frameSize) == doctest::Approx (direct.pitchYin (signal.data() + start, frameSize)).epsilon (1e-6));
+        }
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("GistStreamTest")
+    {
+        const int frameSize = 2048;
+        const int hopSize = 256;
+        std::vector<float> signal (frameSize * 8);
+        
+        for (size_t i = 0; i < signal.size(); i++)
+            signal[i] = (float)(0.8 * sin (2. * M_PI * 196. * i / 44100.));
+        
+        Gist<float> g1 (frameSize, 44100);
+        Gist<float> g2 (frameSize, 44100);
+        g1.setHopSize (hopSize);
+        g2.setHopSize (hopSize);
+        g2.setYinDifferenceMethod (IncrementalDifference);
+        
+        std::vector<float> pitches1, pitches2;
+        
+        g1.processAudioStream (signal.data(), signal.size(), [&]() { pitches1.push_back (g1.pitch()); });
+        g2.processAudioStream (signal.data(), signal.size(), [&]() { pitches2.push_back (g2.pitch()); });
+        
+        REQUIRE_EQ (pitches1.size(), pitches2.size());
+        
+        for (size_t i = 0; i < pitches1.size(); i++)
+            CHECK (pitches2[i] == doctest::Approx (pitches1[i]).epsilon (0.001));
+        
+        // analyse() at another hop size
+        std::vector<float> output1, output2;
+        g1.analyse (signal.data(), signal.size(), 128, PitchFeature, output1);
+        g2.analyse (signal.data(), signal.size(), 128, PitchFeature, output2);
+        
+        REQUIRE_EQ (output1.size(), output2.size());
+        
+        for (size_t i = 0; i < output1.size(); i++)
+            CHECK (output2[i] == doctest::Approx (output1[i]).epsilon (0.001));
+    }
+}
+
+//=============================================================
+//================== YIN COARSE TO FINE =======================
+//=============================================================
+TEST_SUITE ("PitchYinMultirate")
+{
+    // ------------------------------------------------------------
+    /** a harmonic tone with decaying partials, like a voice or instrument */
+    std::vector<double> createHarmonicFrame (int frameSize, double frequency, int fs)
+    {
+        std::vector<double> frame (frameSize, 0.);
+        
+        for (int harmonic = 1; harmonic * frequency < fs / 2 && harmonic <= 10; harmonic++)
+            for (int i = 0; i < frameSize; i++)
+                frame[i] += sin (2. * M_PI * harmonic * frequency * i / fs + harmonic) / harmonic;
+        
+        return frame;
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("MatchesFullRateTest")
+    {
+        for (int factor : {2, 4})
+        {
+            for (double frequency : {82.4, 110., 196., 261.6, 440., 659.3})
+            {
+                Yin<double> fullRate (44100);
+                Yin<double> multirate (44100);
+                multirate.setDecimationFactor (factor);
+                CHECK_EQ (multirate.getDecimationFactor(), factor);
+                
+                std::vector<double> frame = createHarmonicFrame (2048, frequency, 44100);
+                double pitch = multirate.pitchYin (frame);
+                
+                // within a cent of the full rate estimate
+                CHECK (pitch == doctest::Approx (fullRate.pitchYin (frame)).epsilon (0.0005));
+                CHECK (pitch == doctest::Approx (frequency).epsilon (0.005));
+            }
+        }
+    }
+    
+    // ------------------------------------------------------------
+    TEST_CASE ("SearchRangeTest")
+    {
+        for (double frequency : {90., 150., 300.})
+        {
+            Yin<float> y (16000);
+            y.setMinFrequency (70);
+            y.setMaxFrequency (400);
+            y.setDecimationFactor (4);
+            
+            std::vector<double> harmonicFrame = createHarmonicFrame (1024, frequency, 16000);
+            std::vector<float> frame (harmonicFrame.begin(), harmonicFrame.end());
+            
+            CHECK (y.pitchYin (frame) == doctest::Approx (frequency).epsilon (0.005));
+        }
+        
+        Yin<float> y (16000);
+        y.setDecimationFactor (4);
+        
+        std::vector<float> silence (1024, 0.f);
+        CHECK (std::isfinite (y.pitchYin (silence)));
+    }
+
+    // ------------------------------------------------------------
+    TEST_CASE ("GistTest")
+    {
+        Gist<double> g1 (2048, 44100);
+        Gist<double> g2 (2048, 44100);
+        g2.setPitchDecimationFactor (4);
+        
+        std::vector<double> frame = createHarmonicFrame (2048, 146.8, 44100);
+        g1.processAudioFrame (frame);
+        g2.processAudioFrame (frame);
+        
+        CHECK (g2.pitch() == doctest::Approx (g1.pitch()).epsilon (0.0005));
+    }
+}
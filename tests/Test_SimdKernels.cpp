@@ -0,0 +1,168 @@
+#include "doctest.h"
+#include <SimdKernels.h>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+//=============================================================
+/** Fills a vector with values between -1 and 1 that are the same on every run */
+template <class T>
+static std::vector<T> makeTestSignal (size_t numValues, unsigned int seed)
+{
+    std::vector<T> values (numValues);
+    srand (seed);
+
+    for (size_t i = 0; i < numValues; i++)
+        values[i] = (T)((rand() / (double)RAND_MAX) * 2.0 - 1.0);
+
+    return values;
+}
+
+//=============================================================
+template <class T>
+static void checkClose (T value, T expected, T scale)
+{
+    const T epsilon = sizeof (T) == sizeof (float) ? (T)1e-4 : (T)1e-10;
+    CHECK (std::abs (value - expected) <= epsilon * ((T)1 + std::abs (scale)));
+}
+
+//=============================================================
+/** Checks every kernel of an instruction set against the scalar kernels, over lengths that leave every size of tail */
+template <class T>
+static void checkKernelsMatchScalar (const SimdKernels<T>& kernels)
+{
+    const SimdKernels<T>& scalar = *SimdKernels<T>::find (ScalarInstructionSet);
+    const size_t lengths[] = {1, 3, 7, 16, 17, 31, 64, 257, 513};
+
+    for (size_t length : lengths)
+    {
+        INFO (SimdKernels<T>::getName (kernels.instructionSet) << " with " << length << " values");
+
+        std::vector<T> a = makeTestSignal<T> (length * 2, 1);
+        std::vector<T> b = makeTestSignal<T> (length * 2, 2);
+        std::vector<T> positive (length);
+
+        for (size_t i = 0; i < length; i++)
+            positive[i] = std::abs (a[i]);
+
+        std::vector<T> result (length), expected (length);
+
+        kernels.multiply (a.data(), b.data(), result.data(), length);
+        scalar.multiply (a.data(), b.data(), expected.data(), length);
+
+        for (size_t i = 0; i < length; i++)
+            checkClose<T> (result[i], expected[i], expected[i]);
+
+        kernels.powerSpectrum (a.data(), b.data(), result.data(), length);
+        scalar.powerSpectrum (a.data(), b.data(), expected.data(), length);
+
+        for (size_t i = 0; i < length; i++)
+            checkClose<T> (result[i], expected[i], expected[i]);
+
+        kernels.squareRoot (positive.data(), result.data(), length);
+        scalar.squareRoot (positive.data(), expected.data(), length);
+
+        for (size_t i = 0; i < length; i++)
+            checkClose<T> (result[i], expected[i], expected[i]);
+
+        checkClose<T> (kernels.dotProduct (a.data(), b.data(), length), scalar.dotProduct (a.data(), b.data(), length), (T)length);
+        checkClose<T> (kernels.squaredDifferenceSum (a.data(), b.data(), length), scalar.squaredDifferenceSum (a.data(), b.data(), length), (T)length);
+
+        std::vector<T> sums (length, (T)1), expectedSums (length, (T)1);
+        kernels.slideDifferenceSums (sums.data(), a.data(), b.data(), length);
+        scalar.slideDifferenceSums (expectedSums.data(), a.data(), b.data(), length);
+
+        for (size_t i = 0; i < length; i++)
+            checkClose<T> (sums[i], expectedSums[i], expectedSums[i]);
+
+        T spectralSums[4], expectedSpectralSums[4];
+        kernels.spectralSums (positive.data(), length, spectralSums);
+        scalar.spectralSums (positive.data(), length, expectedSpectralSums);
+
+        checkClose<T> (spectralSums[0], expectedSpectralSums[0], expectedSpectralSums[0]);
+        checkClose<T> (spectralSums[1], expectedSpectralSums[1], expectedSpectralSums[1]);
+        checkClose<T> (spectralSums[2], expectedSpectralSums[2], expectedSpectralSums[2]);
+        CHECK_EQ (spectralSums[3], expectedSpectralSums[3]);
+
+        T moments[2], expectedMoments[2];
+        const T mean = expectedSpectralSums[0] / (T)length;
+        kernels.centralMoments (positive.data(), length, mean, moments);
+        scalar.centralMoments (positive.data(), length, mean, expectedMoments);
+
+        checkClose<T> (moments[0], expectedMoments[0], expectedMoments[0]);
+        checkClose<T> (moments[1], expectedMoments[1], expectedMoments[1]);
+
+        T statistics[3], expectedStatistics[3];
+        kernels.timeDomainStatistics (a.data(), length, statistics);
+        scalar.timeDomainStatistics (a.data(), length, expectedStatistics);
+
+        checkClose<T> (statistics[0], expectedStatistics[0], expectedStatistics[0]);
+        CHECK_EQ (statistics[1], expectedStatistics[1]);
+        CHECK_EQ (statistics[2], expectedStatistics[2]);
+
+        // two frames in a row, so that the second uses the history left by the first
+        std::vector<T> history[2][5];
+
+        for (int h = 0; h < 2; h++)
+        {
+            for (int v = 0; v < 5; v++)
+                history[h][v].assign (length, (v == 1 || v == 3) ? (T)1 : (T)0);
+        }
+
+        for (int frame = 0; frame < 2; frame++)
+        {
+            std::vector<T> real = makeTestSignal<T> (length, 3 + frame);
+            std::vector<T> imag = makeTestSignal<T> (length, 5 + frame);
+            T differences[2][4] = {{0, 0, 0, 0}, {0, 0, 0, 0}};
+
+            for (int h = 0; h < 2; h++)
+            {
+                SpectralHistoryPointers<T> pointers = {history[h][0].data(), history[h][1].data(), history[h][2].data(), history[h][3].data(), history[h][4].data()};
+                const SimdKernels<T>& k = h == 0 ? kernels : scalar;
+                k.spectralDifferences (nullptr, real.data(), imag.data(), pointers, 0, length, differences[h]);
+            }
+
+            for (int j = 0; j < 4; j++)
+                checkClose<T> (differences[0][j], differences[1][j], differences[1][j]);
+        }
+    }
+}
+
+//=============================================================
+//======================= SIMD KERNELS ========================
+//=============================================================
+TEST_SUITE ("SimdKernels")
+{
+    // ------------------------------------------------------------
+    // 1. Check that the kernels chosen for this CPU are available and are the widest available
+    TEST_CASE ("Dispatch_Test")
+    {
+        const SimdKernels<float>& kernels = SimdKernels<float>::get();
+
+        CHECK (SimdKernels<float>::find (kernels.instructionSet) == &kernels);
+        CHECK (SimdKernels<float>::find (ScalarInstructionSet) != nullptr);
+        CHECK (SimdKernels<double>::get().instructionSet == kernels.instructionSet);
+    }
+
+    // ------------------------------------------------------------
+    // 2. Check that every instruction set available gives the same results as the scalar kernels
+    TEST_CASE ("Float_MatchesScalar_Test")
+    {
+        for (int i = 0; i < NumSimdInstructionSets; i++)
+        {
+            if (const SimdKernels<float>* kernels = SimdKernels<float>::find ((SimdInstructionSet)i))
+                checkKernelsMatchScalar<float> (*kernels);
+        }
+    }
+
+    // ------------------------------------------------------------
+    // 3. Check the same for double precision
+    TEST_CASE ("Double_MatchesScalar_Test")
+    {
+        for (int i = 0; i < NumSimdInstructionSets; i++)
+        {
+            if (const SimdKernels<double>* kernels = SimdKernels<double>::find ((SimdInstructionSet)i))
+                checkKernelsMatchScalar<double> (*kernels);
+        }
+    }
+}